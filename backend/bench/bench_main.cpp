@@ -0,0 +1,775 @@
+// Microbenchmarks for the DataStore and CSVParser hot paths.
+//
+// Each benchmark runs a number of timed batches and prints one JSON object
+// per line to stdout, so results from two commits can be diffed or loaded
+// into a spreadsheet directly:
+//
+//   {"benchmark":"get_airport_by_iata","batches":50,"ops_per_batch":7698,
+//    "median_ns_per_op":41.2,"min_ns_per_op":39.8,"max_ns_per_op":55.0}
+//
+// Compression benchmarks add a size line per codec, e.g.
+//
+//   {"benchmark":"compress/airport_list/gzip-6","input_bytes":2400000,
+//    "output_bytes":410000,"ratio":0.171}
+//
+// Hot-record benchmarks add a cache-miss line when the kernel allows
+// hardware counters (perf_event_open), e.g.
+//
+//   {"benchmark":"hot_records/scan/hot","cache_misses_per_op":0.031}
+//
+// Usage: flight_bench [--data-dir data] [--filter <substring>] [--batches N]
+#include "database/csv_parser.hpp"
+#include "database/data_store.hpp"
+#include "database/network_analytics.hpp"
+#include "database/reachability.hpp"
+#include "compression/codec.hpp"
+#include "encoding/msgpack.hpp"
+#include "compression/precompressed_response.hpp"
+#include "utils/parallel.hpp"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Keep the optimizer from discarding results
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct BenchConfig {
+    std::string data_dir = "data";
+    std::string filter;
+    int batches = 30;
+};
+
+class BenchRunner {
+public:
+    BenchRunner(const BenchConfig& config, std::ostream& out) : config_(config), out_(out) {}
+
+    // `batch` performs one batch of work and returns the number of operations it did
+    void run(const std::string& name, const std::function<size_t()>& batch, int batches = 0) {
+        if (!config_.filter.empty() && name.find(config_.filter) == std::string::npos) {
+            return;
+        }
+        if (batches <= 0) batches = config_.batches;
+
+        batch(); // Warm-up
+
+        std::vector<double> ns_per_op;
+        size_t ops = 0;
+        for (int i = 0; i < batches; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            ops = batch();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+            ns_per_op.push_back(ns / std::max<size_t>(ops, 1));
+        }
+        std::sort(ns_per_op.begin(), ns_per_op.end());
+
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "{\"benchmark\":\"%s\",\"batches\":%d,\"ops_per_batch\":%zu,"
+                      "\"median_ns_per_op\":%.1f,\"min_ns_per_op\":%.1f,\"max_ns_per_op\":%.1f}",
+                      name.c_str(), batches, ops, ns_per_op[ns_per_op.size() / 2],
+                      ns_per_op.front(), ns_per_op.back());
+        out_ << line << std::endl;
+    }
+
+    // Bytes in/out of a size-reducing transform, on its own line
+    void report_size(const std::string& name, size_t input_bytes, size_t output_bytes) {
+        if (!config_.filter.empty() && name.find(config_.filter) == std::string::npos) {
+            return;
+        }
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "{\"benchmark\":\"%s\",\"input_bytes\":%zu,\"output_bytes\":%zu,\"ratio\":%.3f}",
+                      name.c_str(), input_bytes, output_bytes,
+                      double(output_bytes) / std::max<size_t>(input_bytes, 1));
+        out_ << line << std::endl;
+    }
+
+    // Hardware cache misses per operation, on its own line
+    void report_misses(const std::string& name, double misses_per_op) {
+        if (!config_.filter.empty() && name.find(config_.filter) == std::string::npos) {
+            return;
+        }
+        char line[512];
+        std::snprintf(line, sizeof(line), "{\"benchmark\":\"%s\",\"cache_misses_per_op\":%.3f}",
+                      name.c_str(), misses_per_op);
+        out_ << line << std::endl;
+    }
+
+private:
+    const BenchConfig& config_;
+    std::ostream& out_;
+};
+
+// Counts last-level cache misses of this thread while running; invalid
+// where the kernel or VM does not expose hardware counters
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool valid() const { return fd_ >= 0; }
+
+    template <typename Work>
+    uint64_t measure(Work work) {
+        ioctl_(PERF_EVENT_IOC_RESET);
+        ioctl_(PERF_EVENT_IOC_ENABLE);
+        work();
+        ioctl_(PERF_EVENT_IOC_DISABLE);
+        uint64_t count = 0;
+        if (read(fd_, &count, sizeof(count)) != sizeof(count)) return 0;
+        return count;
+    }
+
+private:
+    void ioctl_(unsigned long request) { ::ioctl(fd_, request, 0); }
+
+    int fd_ = -1;
+};
+
+// Fixed airport pairs: hub-to-hub, hub-to-leaf, leaf-to-hub and leaf-to-leaf
+const std::vector<std::pair<std::string, std::string>> kOneHopPairs = {
+    {"ATL", "LHR"}, {"FRA", "ORD"}, {"JFK", "CDG"}, {"DXB", "SYD"},
+    {"LHR", "GKA"}, {"ORD", "BRW"}, {"GKA", "FRA"}, {"GKA", "MAG"},
+};
+
+const std::vector<std::string> kReportAirlines = {"AA", "LH", "FR", "2B"};
+const std::vector<std::string> kReportAirports = {"ATL", "FRA", "DXB", "GKA"};
+
+void bench_parser(BenchRunner& runner, const std::string& data_dir) {
+    runner.run("csv_parse_airports", [&] {
+        auto airports = CSVParser::parse_airports(data_dir + "/airports.csv");
+        do_not_optimize(airports);
+        return airports.size();
+    }, 5);
+    runner.run("csv_parse_airlines", [&] {
+        auto airlines = CSVParser::parse_airlines(data_dir + "/airlines.csv");
+        do_not_optimize(airlines);
+        return airlines.size();
+    }, 5);
+    runner.run("csv_parse_routes", [&] {
+        auto routes = CSVParser::parse_routes(data_dir + "/routes.csv");
+        do_not_optimize(routes);
+        return routes.size();
+    }, 5);
+}
+
+// Full (parallel) build of the /api/analytics counters, as done at load time
+void bench_analytics(BenchRunner& runner, const std::string& data_dir) {
+    NetworkAnalytics::AirportMap airports;
+    for (auto& airport : CSVParser::parse_airports(data_dir + "/airports.csv")) {
+        airports[airport.id] = std::move(airport);
+    }
+    auto routes = CSVParser::parse_routes(data_dir + "/routes.csv");
+
+    runner.run("network_analytics/build", [&] {
+        NetworkAnalytics analytics;
+        analytics.build(routes, airports);
+        do_not_optimize(analytics);
+        return size_t(1);
+    }, 10);
+
+    // Incremental maintenance: retract and re-apply every route once
+    NetworkAnalytics analytics;
+    analytics.build(routes, airports);
+    runner.run("network_analytics/remove+add_route", [&] {
+        for (const auto& route : routes) {
+            analytics.remove_route(route, airports);
+            analytics.add_route(route, airports);
+        }
+        return routes.size();
+    }, 5);
+
+    // SCC + closure + landmark BFS over routes between known airports
+    std::vector<std::pair<int, int>> edges;
+    for (const auto& route : routes) {
+        if (airports.count(route.source_airport_id) && airports.count(route.dest_airport_id)) {
+            edges.emplace_back(route.source_airport_id, route.dest_airport_id);
+        }
+    }
+    runner.run("reachability/build", [&] {
+        Reachability reachability;
+        reachability.build(edges);
+        do_not_optimize(reachability);
+        return size_t(1);
+    }, 10);
+}
+
+void bench_lookups(BenchRunner& runner, const DataStore& store) {
+    std::vector<std::string> airport_codes;
+    for (const auto& airport : store.get_all_airports_sorted_by_iata()) {
+        airport_codes.push_back(airport.iata);
+    }
+    std::vector<std::string> airport_codes_lower;
+    std::vector<std::string> airport_icao_codes;
+    for (const auto& airport : store.get_all_airports_sorted_by_iata()) {
+        std::string lower = airport.iata;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        airport_codes_lower.push_back(lower);
+        airport_icao_codes.push_back(airport.icao);
+    }
+    std::vector<std::string> airline_codes;
+    for (const auto& airline : store.get_all_airlines_sorted_by_iata()) {
+        airline_codes.push_back(airline.iata);
+    }
+
+    runner.run("get_airport_by_iata", [&] {
+        for (const auto& code : airport_codes) {
+            auto airport = store.get_airport_by_iata(code);
+            do_not_optimize(airport);
+        }
+        return airport_codes.size();
+    });
+    runner.run("get_airline_by_iata", [&] {
+        for (const auto& code : airline_codes) {
+            auto airline = store.get_airline_by_iata(code);
+            do_not_optimize(airline);
+        }
+        return airline_codes.size();
+    });
+    runner.run("read/airport_by_iata", [&] {
+        auto view = store.read();
+        for (const auto& code : airport_codes) {
+            auto airport = view.airport_by_iata(code);
+            do_not_optimize(airport);
+        }
+        return airport_codes.size();
+    });
+    runner.run("read/airport_by_iata/lowercase", [&] {
+        auto view = store.read();
+        for (const auto& code : airport_codes_lower) {
+            auto airport = view.airport_by_iata(code);
+            do_not_optimize(airport);
+        }
+        return airport_codes_lower.size();
+    });
+    runner.run("read/airport_by_icao", [&] {
+        auto view = store.read();
+        for (const auto& code : airport_icao_codes) {
+            auto airport = view.airport_by_icao(code);
+            do_not_optimize(airport);
+        }
+        return airport_icao_codes.size();
+    });
+    runner.run("get_airport_by_iata/miss", [&] {
+        for (int i = 0; i < 1000; ++i) {
+            auto airport = store.get_airport_by_iata("ZZ9");
+            do_not_optimize(airport);
+        }
+        return size_t(1000);
+    });
+}
+
+void bench_reports(BenchRunner& runner, const DataStore& store) {
+    for (const auto& iata : kReportAirlines) {
+        runner.run("get_airports_by_airline_routes/" + iata, [&] {
+            auto results = store.get_airports_by_airline_routes(iata);
+            do_not_optimize(results);
+            return size_t(1);
+        });
+    }
+    for (const auto& iata : kReportAirports) {
+        runner.run("get_airlines_by_airport_routes/" + iata, [&] {
+            auto results = store.get_airlines_by_airport_routes(iata);
+            do_not_optimize(results);
+            return size_t(1);
+        });
+    }
+
+    runner.run("get_all_airports_sorted_by_iata", [&] {
+        auto airports = store.get_all_airports_sorted_by_iata();
+        do_not_optimize(airports);
+        return size_t(1);
+    });
+    runner.run("get_all_airlines_sorted_by_iata", [&] {
+        auto airlines = store.get_all_airlines_sorted_by_iata();
+        do_not_optimize(airlines);
+        return size_t(1);
+    });
+
+    for (const auto& [source, dest] : kOneHopPairs) {
+        runner.run("find_one_hop_routes/" + source + "-" + dest, [&] {
+            auto results = store.find_one_hop_routes(source, dest);
+            do_not_optimize(results);
+            return size_t(1);
+        });
+    }
+    for (const auto& [source, dest] : kOneHopPairs) {
+        runner.run("read/one_hop_routes/" + source + "-" + dest, [&] {
+            auto view = store.read();
+            auto results = view.one_hop_routes(*view.airport_by_iata(source),
+                                               *view.airport_by_iata(dest));
+            do_not_optimize(results);
+            return size_t(1);
+        });
+    }
+    for (const auto& [source, dest] : kOneHopPairs) {
+        runner.run("read/one_hop/cached/" + source + "-" + dest, [&] {
+            auto view = store.read();
+            auto results = view.one_hop(*view.airport_by_iata(source), *view.airport_by_iata(dest));
+            do_not_optimize(results);
+            return size_t(1);
+        });
+    }
+    for (const auto& [source, dest] : kOneHopPairs) {
+        runner.run("read/hop_lower_bound/" + source + "-" + dest, [&] {
+            auto view = store.read();
+            int legs = view.hop_lower_bound(*view.airport_by_iata(source),
+                                            *view.airport_by_iata(dest));
+            do_not_optimize(legs);
+            return size_t(1);
+        });
+    }
+}
+
+// One background centrality run (PageRank + 256 sampled betweenness sources)
+void bench_centrality(BenchRunner& runner, const DataStore& store) {
+    std::vector<std::pair<int, int>> edges;
+    {
+        auto view = store.read();
+        for (const Route* route : view.filter_routes(RouteFilter{})) {
+            edges.emplace_back(route->source_airport_id, route->dest_airport_id);
+        }
+    }
+    // Sized like CentralityJob's pool
+    utils::Executor pool(std::max<size_t>(1, utils::default_parallelism() - 1));
+    runner.run("compute_centrality", [&] {
+        auto scores = compute_centrality(edges, 256, pool);
+        do_not_optimize(scores);
+        return size_t(1);
+    }, 5);
+}
+
+// Route filter scans over the columnar table, from selective to broad
+void bench_filters(BenchRunner& runner, const DataStore& store) {
+    auto source = store.get_airport_by_iata("ATL");
+    auto airline = store.get_airline_by_iata("AA");
+    auto a380_hub = store.get_airport_by_iata("DXB");
+    if (!source || !airline || !a380_hub) {
+        std::cerr << "Filter benchmarks need ATL, DXB and AA in the data set" << std::endl;
+        return;
+    }
+
+    std::vector<std::pair<std::string, RouteFilter>> filters(6);
+    filters[0].first = "source";
+    filters[0].second.source_airport_id = source->id;
+    filters[1].first = "airline+source";
+    filters[1].second.airline_id = airline->id;
+    filters[1].second.source_airport_id = source->id;
+    filters[2].first = "stops";
+    filters[2].second.stops = 0;
+    filters[3].first = "equipment";
+    filters[3].second.equipment = "738";
+    filters[4].first = "codeshare+equipment";
+    filters[4].second.codeshare = true;
+    filters[4].second.equipment = "320";
+    filters[5].first = "equipment+source";
+    filters[5].second.equipment = "388";
+    filters[5].second.source_airport_id = a380_hub->id;
+
+    for (const auto& [name, filter] : filters) {
+        runner.run(std::string("filter_routes/") + RouteColumns::kernel_name() + "/" + name, [&] {
+            auto view = store.read();
+            auto routes = view.filter_routes(filter);
+            do_not_optimize(routes);
+            return size_t(1);
+        });
+    }
+}
+
+void bench_serialization(BenchRunner& runner, const DataStore& store) {
+    auto airports = store.get_all_airports_sorted_by_iata();
+    auto airlines = store.get_all_airlines_sorted_by_iata();
+    auto one_hop = store.find_one_hop_routes("ATL", "LHR");
+
+    runner.run("to_json/airport", [&] {
+        for (const auto& airport : airports) {
+            auto body = airport.to_json().dump();
+            do_not_optimize(body);
+        }
+        return airports.size();
+    });
+    runner.run("to_json/airline", [&] {
+        for (const auto& airline : airlines) {
+            auto body = airline.to_json().dump();
+            do_not_optimize(body);
+        }
+        return airlines.size();
+    });
+    runner.run("to_json/route", [&] {
+        for (const auto& connection : one_hop) {
+            auto body = connection.first_leg.to_json().dump();
+            do_not_optimize(body);
+        }
+        return one_hop.size();
+    });
+    runner.run("to_json/airport_list", [&] {
+        crow::json::wvalue json;
+        std::vector<crow::json::wvalue> airports_json;
+        for (const auto& airport : airports) {
+            airports_json.push_back(airport.to_json());
+        }
+        json["airports"] = std::move(airports_json);
+        json["total"] = airports.size();
+        auto body = json.dump();
+        do_not_optimize(body);
+        return size_t(1);
+    }, 10);
+}
+
+// The airport list as MessagePack: encoded straight from the models in
+// each layout, and transcoded from its JSON body as non-list endpoints are.
+// Size lines compare each body against the JSON one.
+void bench_msgpack(BenchRunner& runner, const DataStore& store) {
+    auto view = store.read();
+    auto airports = view.airports_sorted_by_iata();
+    auto encode = [&](msgpack::Format format) {
+        msgpack::Writer out;
+        out.reserve(airports.size() * 128);
+        out.map(2);
+        out.string("airports");
+        msgpack::write_list(out, airports, format);
+        out.string("total");
+        out.uinteger(airports.size());
+        return out.take();
+    };
+
+    crow::json::wvalue json;
+    std::vector<crow::json::wvalue> airports_json;
+    for (auto airport : airports) {
+        airports_json.push_back(airport->to_json());
+    }
+    json["airports"] = std::move(airports_json);
+    json["total"] = airports.size();
+    const std::string body = json.dump();
+
+    runner.report_size("msgpack/airport_list/rows", body.size(), encode(msgpack::Format::Rows).size());
+    runner.report_size("msgpack/airport_list/columns", body.size(), encode(msgpack::Format::Columns).size());
+    for (auto [name, format] : {std::pair("rows", msgpack::Format::Rows),
+                                std::pair("columns", msgpack::Format::Columns)}) {
+        runner.run(std::string("msgpack/airport_list/") + name, [&, format = format] {
+            auto packed = encode(format);
+            do_not_optimize(packed);
+            return size_t(1);
+        }, 10);
+    }
+    runner.run("msgpack/airport_list/from_json", [&] {
+        std::string packed;
+        msgpack::from_json(body, packed);
+        do_not_optimize(packed);
+        return size_t(1);
+    }, 10);
+}
+
+// Bandwidth vs CPU of compressing the full list bodies: the cost of each
+// codec and level on the fly, against serving a body precompressed once
+// per data version
+void bench_compression(BenchRunner& runner, const DataStore& store) {
+    auto build_airport_list = [&store] {
+        auto view = store.read();
+        crow::json::wvalue json;
+        auto airports = view.airports_sorted_by_iata();
+        std::vector<crow::json::wvalue> airports_json;
+        for (auto airport : airports) {
+            airports_json.push_back(airport->to_json());
+        }
+        json["airports"] = std::move(airports_json);
+        json["total"] = airports.size();
+        return json.dump();
+    };
+    auto build_airline_list = [&store] {
+        auto view = store.read();
+        crow::json::wvalue json;
+        auto airlines = view.airlines_sorted_by_iata();
+        std::vector<crow::json::wvalue> airlines_json;
+        for (auto airline : airlines) {
+            airlines_json.push_back(airline->to_json());
+        }
+        json["airlines"] = std::move(airlines_json);
+        json["total"] = airlines.size();
+        return json.dump();
+    };
+
+    const std::vector<std::pair<std::string, std::string>> bodies = {
+        {"airport_list", build_airport_list()},
+        {"airline_list", build_airline_list()},
+    };
+    const compression::Encoding encodings[] = {compression::Encoding::Gzip,
+                                               compression::Encoding::Deflate};
+
+    for (const auto& [name, body] : bodies) {
+        for (auto encoding : encodings) {
+            for (int level : {1, 6, 9}) {
+                std::string label = "compress/" + name + "/" +
+                                    compression::encoding_name(encoding) + "-" + std::to_string(level);
+                runner.report_size(label, body.size(),
+                                   compression::compress(body, encoding, level).size());
+                runner.run(label, [&] {
+                    auto compressed = compression::compress(body, encoding, level);
+                    do_not_optimize(compressed);
+                    return size_t(1);
+                }, 10);
+            }
+        }
+    }
+
+    // Hit path of the /api/airports handler: no build, no compression
+    PrecompressedResponse precompressed;
+    utils::Deadline deadline;
+    uint64_t generation, version;
+    {
+        auto view = store.read();
+        generation = view.generation();
+        version = view.version();
+    }
+    for (const char* accept : {"identity", "gzip"}) {
+        runner.run(std::string("precompressed/airport_list/") + accept, [&] {
+            auto response = precompressed.serve(accept, generation, version, deadline, build_airport_list);
+            do_not_optimize(response);
+            return size_t(1);
+        });
+    }
+}
+
+// Hot/cold split: bytes of the hot records against the full entities, and
+// the one-hop second-leg scan (check dest and stops of every route out of
+// an airport, in adjacency order) over each layout
+void bench_hot_records(BenchRunner& runner, const DataStore& store) {
+    auto footprint = store.get_hot_footprint();
+    runner.report_size("hot_records/airports", footprint.airport_full_bytes, footprint.airport_hot_bytes);
+    runner.report_size("hot_records/routes", footprint.route_full_bytes, footprint.route_hot_bytes);
+
+    StoreSnapshot tables = store.snapshot();
+    const std::vector<Route>& routes = tables.routes;
+    std::vector<RouteHot> hot;
+    hot.reserve(routes.size());
+    std::unordered_map<int, std::vector<size_t>> rows_from;
+    for (size_t row = 0; row < routes.size(); ++row) {
+        const Route& r = routes[row];
+        hot.push_back({r.airline_id, r.source_airport_id, r.dest_airport_id, r.stops});
+        rows_from[r.source_airport_id].push_back(row);
+    }
+    std::vector<size_t> order;
+    order.reserve(routes.size());
+    for (const auto& [airport_id, rows] : rows_from) {
+        order.insert(order.end(), rows.begin(), rows.end());
+    }
+    int target = store.get_airport_by_iata("LHR") ? store.get_airport_by_iata("LHR")->id : 0;
+
+    auto scan = [&](const auto& table) {
+        size_t matches = 0;
+        for (size_t row : order) {
+            matches += table[row].dest_airport_id == target && table[row].stops == 0;
+        }
+        do_not_optimize(matches);
+        return order.size();
+    };
+    runner.run("hot_records/scan/full", [&] { return scan(routes); });
+    runner.run("hot_records/scan/hot", [&] { return scan(hot); });
+
+    CacheMissCounter counter;
+    if (counter.valid()) {
+        double full = counter.measure([&] { scan(routes); });
+        double packed = counter.measure([&] { scan(hot); });
+        runner.report_misses("hot_records/scan/full", full / order.size());
+        runner.report_misses("hot_records/scan/hot", packed / order.size());
+    }
+}
+
+// Mutations are measured in insert/remove pairs so the store ends each
+// batch in the state it started in
+void bench_mutations(BenchRunner& runner, DataStore& store) {
+    constexpr int kBaseId = 900000;
+    constexpr int kOps = 20;
+
+    Airport airport{};
+    airport.name = "Bench Field";
+    airport.city = "Bench";
+    airport.country = "Nowhere";
+    airport.iata = "ZZB";
+    airport.icao = "ZZZB";
+
+    Airline airline{};
+    airline.name = "Bench Air";
+    airline.iata = "Z9";
+    airline.active = "Y";
+
+    auto source = store.get_airport_by_iata("ATL");
+    auto dest = store.get_airport_by_iata("LHR");
+    auto carrier = store.get_airline_by_iata("AA");
+    if (!source || !dest || !carrier) {
+        std::cerr << "Mutation benchmarks need ATL, LHR and AA in the data set" << std::endl;
+        return;
+    }
+
+    runner.run("insert_airport+remove_airport", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            airport.id = kBaseId + i;
+            store.insert_airport(airport);
+            store.remove_airport(airport.id);
+        }
+        return size_t(kOps);
+    }, 5);
+    runner.run("insert_airline+remove_airline", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            airline.id = kBaseId + i;
+            store.insert_airline(airline);
+            store.remove_airline(airline.id);
+        }
+        return size_t(kOps);
+    }, 5);
+
+    // The synthetic airline carries the routes so removal leaves real data untouched
+    airline.id = kBaseId;
+    store.insert_airline(airline);
+    Route route{};
+    route.airline_iata = airline.iata;
+    route.airline_id = airline.id;
+    route.source_airport_iata = source->iata;
+    route.source_airport_id = source->id;
+    route.dest_airport_iata = dest->iata;
+    route.dest_airport_id = dest->id;
+    route.equipment = "777";
+
+    runner.run("insert_route+remove_route", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            store.insert_route(route);
+            store.remove_route(route.airline_id, route.source_airport_id, route.dest_airport_id);
+        }
+        return size_t(kOps);
+    }, 5);
+
+    // The same pairs from several writers, each on its own source airport
+    const std::vector<std::string> writer_sources = {"ATL", "FRA", "DXB", "ORD"};
+    std::vector<Route> writer_routes;
+    for (const auto& iata : writer_sources) {
+        auto airport = store.get_airport_by_iata(iata);
+        if (!airport || airport->id == dest->id) continue;
+        Route writer_route = route;
+        writer_route.source_airport_iata = airport->iata;
+        writer_route.source_airport_id = airport->id;
+        writer_routes.push_back(writer_route);
+    }
+    runner.run("insert_route+remove_route/" + std::to_string(writer_routes.size()) + "_writers", [&] {
+        std::vector<std::thread> writers;
+        for (const auto& writer_route : writer_routes) {
+            writers.emplace_back([&store, &writer_route]() {
+                for (int i = 0; i < kOps; ++i) {
+                    store.insert_route(writer_route);
+                    store.remove_route(writer_route.airline_id, writer_route.source_airport_id,
+                                       writer_route.dest_airport_id);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        return size_t(kOps) * writer_routes.size();
+    }, 5);
+
+    store.insert_route(route);
+    auto route_update = crow::json::load(R"({"equipment":"788 77W","stops":0})");
+    runner.run("modify_route", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            store.modify_route(route.airline_id, route.source_airport_id,
+                               route.dest_airport_id, route_update);
+        }
+        return size_t(kOps);
+    }, 5);
+    store.remove_airline(airline.id);
+
+    auto airport_update = crow::json::load(R"({"name":"Bench Renamed","altitude":1026})");
+    runner.run("modify_airport", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            store.modify_airport(source->id, airport_update);
+        }
+        return size_t(kOps);
+    }, 5);
+
+    auto airline_update = crow::json::load(R"({"callsign":"BENCH","active":"Y"})");
+    runner.run("modify_airline", [&] {
+        for (int i = 0; i < kOps; ++i) {
+            store.modify_airline(carrier->id, airline_update);
+        }
+        return size_t(kOps);
+    }, 5);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--data-dir" && i + 1 < argc) {
+            config.data_dir = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            config.filter = argv[++i];
+        } else if (arg == "--batches" && i + 1 < argc) {
+            config.batches = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "Options:\n"
+                      << "  --data-dir <path>  Path to data directory (default: data)\n"
+                      << "  --filter <text>    Only run benchmarks whose name contains text\n"
+                      << "  --batches <n>      Timed batches per benchmark (default: 30)\n"
+                      << "  --help, -h         Show this help message\n";
+            return 0;
+        }
+    }
+
+    // Results go to the real stdout; the store's progress logging is muted
+    std::ostream results(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+
+    BenchRunner runner(config, results);
+    bench_parser(runner, config.data_dir);
+    bench_analytics(runner, config.data_dir);
+
+    DataStore store;
+    if (!store.load_data(config.data_dir + "/airports.csv",
+                         config.data_dir + "/airlines.csv",
+                         config.data_dir + "/routes.csv")) {
+        std::cerr << "Failed to load data from " << config.data_dir << std::endl;
+        return 1;
+    }
+
+    bench_lookups(runner, store);
+    bench_reports(runner, store);
+    bench_filters(runner, store);
+    bench_centrality(runner, store);
+    bench_serialization(runner, store);
+    bench_msgpack(runner, store);
+    bench_hot_records(runner, store);
+    bench_compression(runner, store);
+    bench_mutations(runner, store);
+
+    return 0;
+}
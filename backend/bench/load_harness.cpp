@@ -0,0 +1,452 @@
+// Closed-loop HTTP load generator for flight_server.
+//
+// Drives the real endpoints over loopback with a configurable read/write
+// mix and reports throughput and latency percentiles per concurrency level.
+// Each sweep point prints JSON lines (one per request class plus "all"):
+//
+//   {"concurrency":8,"class":"one_hop","requests":1234,"errors":0,
+//    "rps":4113.3,"p50_us":812,"p99_us":3020,"p999_us":7110}
+//
+// To measure server-side scaling, pass --server-cmd with a {threads}
+// placeholder; the server is restarted for every sweep point, e.g.
+//   flight_loadgen --sweep 1,2,4,8 --server-cmd "./flight_server --threads {threads}"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum RequestClass { kLookup, kOneHop, kReport, kList, kWrite, kClassCount };
+
+const char* kClassNames[kClassCount] = {"lookup", "one_hop", "report", "list", "write"};
+
+struct Config {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int duration_seconds = 10;
+    std::vector<int> sweep = {1, 2, 4, 8, 16};
+    int mix[kClassCount] = {40, 25, 20, 5, 10};
+    std::string server_cmd;
+};
+
+const std::vector<std::string> kHubs = {
+    "ATL", "ORD", "LHR", "CDG", "FRA", "DXB", "JFK", "LAX", "AMS", "PEK",
+    "HND", "SIN", "IST", "MAD", "DEN", "SYD", "GRU", "YYZ", "MUC", "BKK",
+};
+const std::vector<std::string> kLeaves = {
+    "GKA", "MAG", "HGU", "LAE", "WWK", "BRW", "EVE", "RYG", "LYR", "KZN",
+};
+const std::vector<std::string> kAirlines = {"AA", "UA", "DL", "LH", "BA", "AF", "FR", "EK"};
+
+// Synthetic airline that owns every route the harness writes
+constexpr int kLoadAirlineId = 990001;
+
+// Minimal blocking HTTP/1.1 keep-alive client. Crow always sends a
+// Content-Length, so chunked decoding is not needed.
+class HttpClient {
+public:
+    HttpClient(const std::string& host, int port) : host_(host), port_(port) {}
+    ~HttpClient() { close_socket(); }
+
+    // Returns the HTTP status, or -1 on a transport error
+    int request(const std::string& method, const std::string& path,
+                const std::string& body = "", std::string* response_body = nullptr) {
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (fd_ < 0 && !connect_socket()) return -1;
+
+            std::string req = method + " " + path + " HTTP/1.1\r\nHost: " + host_ +
+                              "\r\nConnection: keep-alive\r\n";
+            if (!body.empty()) {
+                req += "Content-Type: application/json\r\nContent-Length: " +
+                       std::to_string(body.size()) + "\r\n";
+            }
+            req += "\r\n" + body;
+
+            int status = -1;
+            if (send_all(req) && (status = read_response(response_body)) > 0) {
+                return status;
+            }
+            // The server may have closed an idle keep-alive connection; retry once
+            close_socket();
+        }
+        return -1;
+    }
+
+private:
+    bool connect_socket() {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) return false;
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port_);
+        ::inet_pton(AF_INET, host_.c_str(), &addr.sin_addr);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close_socket();
+            return false;
+        }
+        buffer_.clear();
+        return true;
+    }
+
+    void close_socket() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool send_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    bool fill() {
+        char chunk[16384];
+        ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer_.append(chunk, n);
+        return true;
+    }
+
+    int read_response(std::string* response_body) {
+        size_t header_end;
+        while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return -1;
+        }
+
+        std::string headers = buffer_.substr(0, header_end);
+        int status = -1;
+        if (headers.size() > 12) status = std::atoi(headers.c_str() + 9);
+
+        size_t content_length = 0;
+        std::string lower = headers;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        size_t pos = lower.find("content-length:");
+        if (pos != std::string::npos) {
+            content_length = std::strtoul(lower.c_str() + pos + 15, nullptr, 10);
+        }
+
+        size_t total = header_end + 4 + content_length;
+        while (buffer_.size() < total) {
+            if (!fill()) return -1;
+        }
+        if (response_body) {
+            response_body->assign(buffer_, header_end + 4, content_length);
+        }
+        buffer_.erase(0, total);
+        return status;
+    }
+
+    std::string host_;
+    int port_;
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+// Pull `"id":<n>` out of a single-entity JSON response
+int extract_id(const std::string& json) {
+    size_t pos = json.find("\"id\":");
+    return pos == std::string::npos ? -1 : std::atoi(json.c_str() + pos + 5);
+}
+
+struct ClassStats {
+    std::vector<uint32_t> latencies_us;
+    uint64_t errors = 0;
+};
+
+struct WorkerResult {
+    ClassStats classes[kClassCount];
+};
+
+class LoadRun {
+public:
+    LoadRun(const Config& config, const std::vector<int>& airport_ids)
+        : config_(config), airport_ids_(airport_ids) {}
+
+    void worker(int worker_index, WorkerResult& result) {
+        HttpClient client(config_.host, config_.port);
+        std::mt19937 rng(12345 + worker_index);
+        int total_weight = 0;
+        for (int weight : config_.mix) total_weight += weight;
+        std::uniform_int_distribution<int> pick_class(0, std::max(total_weight - 1, 0));
+
+        uint64_t sequence = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            int roll = pick_class(rng);
+            int cls = 0;
+            while (cls < kClassCount - 1 && roll >= config_.mix[cls]) {
+                roll -= config_.mix[cls];
+                ++cls;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            bool ok = issue(client, static_cast<RequestClass>(cls), rng, worker_index, sequence++);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+            auto& stats = result.classes[cls];
+            stats.latencies_us.push_back(static_cast<uint32_t>(elapsed));
+            if (!ok) stats.errors++;
+        }
+    }
+
+    void stop() { stop_.store(true); }
+
+private:
+    template <typename T>
+    static const T& pick(const std::vector<T>& items, std::mt19937& rng) {
+        return items[std::uniform_int_distribution<size_t>(0, items.size() - 1)(rng)];
+    }
+
+    bool issue(HttpClient& client, RequestClass cls, std::mt19937& rng,
+               int worker_index, uint64_t sequence) {
+        switch (cls) {
+            case kLookup:
+                return client.request("GET", "/api/airports/" + pick(kHubs, rng)) == 200;
+            case kOneHop: {
+                // Mostly hub-to-hub, the expensive case, with some leaf traffic
+                bool leaf = std::uniform_int_distribution<int>(0, 3)(rng) == 0;
+                const auto& source = pick(kHubs, rng);
+                const auto& dest = leaf ? pick(kLeaves, rng) : pick(kHubs, rng);
+                return client.request("GET", "/api/routes/one-hop?source=" + source +
+                                             "&dest=" + dest) == 200;
+            }
+            case kReport:
+                if (sequence % 2 == 0) {
+                    return client.request("GET", "/api/airlines/" + pick(kAirlines, rng) + "/airports") == 200;
+                }
+                return client.request("GET", "/api/airports/" + pick(kHubs, rng) + "/airlines") == 200;
+            case kList:
+                return client.request("GET", sequence % 2 == 0 ? "/api/airports" : "/api/airlines") == 200;
+            case kWrite: {
+                // One write op is an insert/delete pair, so the store does not grow
+                if (airport_ids_.size() < 2) return false;
+                // Each worker writes its own source/dest pairs, so inserts never collide
+                int source = airport_ids_[(worker_index + sequence) % airport_ids_.size()];
+                int dest = airport_ids_[(worker_index * 7 + sequence * 3 + 1) % airport_ids_.size()];
+                if (source == dest) dest = airport_ids_[(sequence + 1) % airport_ids_.size()];
+                std::ostringstream body;
+                body << "{\"airline_id\":" << kLoadAirlineId << ",\"source_airport_id\":" << source
+                     << ",\"dest_airport_id\":" << dest << ",\"stops\":0,\"equipment\":\"320\"}";
+                int status = client.request("POST", "/api/routes", body.str());
+                std::string path = "/api/routes/" + std::to_string(kLoadAirlineId) + "/" +
+                                   std::to_string(source) + "/" + std::to_string(dest);
+                int del = client.request("DELETE", path);
+                return (status == 201 || status == 409) && (del == 200 || del == 404);
+            }
+            default:
+                return false;
+        }
+    }
+
+    const Config& config_;
+    const std::vector<int>& airport_ids_;
+    std::atomic<bool> stop_{false};
+};
+
+uint32_t percentile(std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+void report(int concurrency, const char* name, std::vector<uint32_t> latencies,
+            uint64_t errors, double seconds) {
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("{\"concurrency\":%d,\"class\":\"%s\",\"requests\":%zu,\"errors\":%llu,"
+                "\"rps\":%.1f,\"p50_us\":%u,\"p99_us\":%u,\"p999_us\":%u}\n",
+                concurrency, name, latencies.size(), static_cast<unsigned long long>(errors),
+                latencies.size() / seconds, percentile(latencies, 0.5),
+                percentile(latencies, 0.99), percentile(latencies, 0.999));
+    std::fflush(stdout);
+}
+
+bool wait_for_server(const Config& config, int timeout_seconds) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_seconds);
+    while (std::chrono::steady_clock::now() < deadline) {
+        HttpClient probe(config.host, config.port);
+        if (probe.request("GET", "/api/health") == 200) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    return false;
+}
+
+pid_t start_server(const std::string& cmd_template, int threads) {
+    std::string cmd = cmd_template;
+    size_t pos;
+    while ((pos = cmd.find("{threads}")) != std::string::npos) {
+        cmd.replace(pos, 9, std::to_string(threads));
+    }
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::execl("/bin/sh", "sh", "-c", ("exec " + cmd).c_str(), static_cast<char*>(nullptr));
+        std::_Exit(127);
+    }
+    return pid;
+}
+
+void stop_server(pid_t pid) {
+    if (pid <= 0) return;
+    ::kill(pid, SIGTERM);
+    ::waitpid(pid, nullptr, 0);
+}
+
+// Create the synthetic airline and resolve airport ids for route writes
+std::vector<int> prepare(const Config& config) {
+    HttpClient client(config.host, config.port);
+    std::string body;
+    client.request("POST", "/api/airlines",
+                   "{\"id\":" + std::to_string(kLoadAirlineId) +
+                   ",\"name\":\"Load Test Air\",\"iata\":\"\",\"active\":\"N\"}");
+
+    std::vector<int> ids;
+    for (const auto& codes : {kHubs, kLeaves}) {
+        for (const auto& code : codes) {
+            if (client.request("GET", "/api/airports/" + code, "", &body) == 200) {
+                int id = extract_id(body);
+                if (id >= 0) ids.push_back(id);
+            }
+        }
+    }
+    return ids;
+}
+
+void cleanup(const Config& config) {
+    HttpClient client(config.host, config.port);
+    client.request("DELETE", "/api/airlines/" + std::to_string(kLoadAirlineId));
+}
+
+bool parse_mix(const std::string& spec, int (&mix)[kClassCount]) {
+    std::fill(std::begin(mix), std::end(mix), 0);
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        int weight = std::atoi(item.c_str() + eq + 1);
+        auto it = std::find_if(std::begin(kClassNames), std::end(kClassNames),
+                               [&](const char* n) { return name == n; });
+        if (it == std::end(kClassNames)) return false;
+        mix[it - std::begin(kClassNames)] = std::max(weight, 0);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc) {
+            config.host = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            config.port = std::stoi(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            config.duration_seconds = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            config.sweep.clear();
+            std::istringstream in(argv[++i]);
+            std::string item;
+            while (std::getline(in, item, ',')) config.sweep.push_back(std::max(1, std::stoi(item)));
+        } else if (arg == "--mix" && i + 1 < argc) {
+            if (!parse_mix(argv[++i], config.mix)) {
+                std::cerr << "Invalid --mix, expected e.g. lookup=40,one_hop=25,report=20,list=5,write=10"
+                          << std::endl;
+                return 1;
+            }
+        } else if (arg == "--server-cmd" && i + 1 < argc) {
+            config.server_cmd = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "Options:\n"
+                      << "  --host <addr>        Server address (default: 127.0.0.1)\n"
+                      << "  --port <number>      Server port (default: 8080)\n"
+                      << "  --duration <secs>    Measurement time per sweep point (default: 10)\n"
+                      << "  --sweep <n,n,...>    Concurrency levels to run (default: 1,2,4,8,16)\n"
+                      << "  --mix <class=w,...>  Weights for lookup, one_hop, report, list, write\n"
+                      << "                       (default: lookup=40,one_hop=25,report=20,list=5,write=10)\n"
+                      << "  --server-cmd <cmd>   Start the server per sweep point; {threads} is\n"
+                      << "                       replaced by the concurrency level\n"
+                      << "  --help, -h           Show this help message\n";
+            return 0;
+        }
+    }
+
+    if (std::all_of(std::begin(config.mix), std::end(config.mix), [](int w) { return w == 0; })) {
+        std::cerr << "--mix needs at least one non-zero weight" << std::endl;
+        return 1;
+    }
+
+    for (int concurrency : config.sweep) {
+        pid_t server = 0;
+        if (!config.server_cmd.empty()) {
+            server = start_server(config.server_cmd, concurrency);
+        }
+        if (!wait_for_server(config, config.server_cmd.empty() ? 2 : 120)) {
+            std::cerr << "Server at " << config.host << ":" << config.port
+                      << " is not responding" << std::endl;
+            stop_server(server);
+            return 1;
+        }
+
+        auto airport_ids = prepare(config);
+        LoadRun run(config, airport_ids);
+        std::vector<WorkerResult> results(concurrency);
+        std::vector<std::thread> workers;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int w = 0; w < concurrency; ++w) {
+            workers.emplace_back([&run, &results, w] { run.worker(w, results[w]); });
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(config.duration_seconds));
+        run.stop();
+        for (auto& worker : workers) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<uint32_t> all;
+        uint64_t all_errors = 0;
+        for (int cls = 0; cls < kClassCount; ++cls) {
+            std::vector<uint32_t> latencies;
+            uint64_t errors = 0;
+            for (auto& result : results) {
+                auto& stats = result.classes[cls];
+                latencies.insert(latencies.end(), stats.latencies_us.begin(), stats.latencies_us.end());
+                errors += stats.errors;
+            }
+            if (latencies.empty()) continue;
+            all.insert(all.end(), latencies.begin(), latencies.end());
+            all_errors += errors;
+            report(concurrency, kClassNames[cls], std::move(latencies), errors, seconds);
+        }
+        report(concurrency, "all", std::move(all), all_errors, seconds);
+
+        cleanup(config);
+        stop_server(server);
+    }
+
+    return 0;
+}
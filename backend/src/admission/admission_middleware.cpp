@@ -0,0 +1,138 @@
+#include "admission_middleware.hpp"
+#include "../metrics/metrics.hpp"
+#include "../utils/parallel.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using admission::CostClass;
+
+namespace {
+
+constexpr int kClasses = static_cast<int>(CostClass::Count);
+constexpr size_t kBucketShards = 16;
+constexpr size_t kMaxBucketsPerShard = 4096;
+
+using Clock = std::chrono::steady_clock;
+
+struct Bucket {
+    double tokens;
+    Clock::time_point refilled;
+};
+
+struct BucketShard {
+    std::mutex mutex;
+    std::unordered_map<std::string, Bucket> buckets;
+};
+
+const metrics::Counter& rejected_counter(CostClass cost_class, const char* reason) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, metrics::Counter> counters;
+    std::string labels = std::string("class=\"") + admission::class_name(cost_class) +
+                         "\",reason=\"" + reason + "\"";
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = counters.find(labels);
+    if (it == counters.end()) {
+        it = counters.emplace(labels, metrics::counter("flight_admission_rejected_total", labels,
+                                                       "Requests shed by admission control")).first;
+    }
+    return it->second;
+}
+
+void reject(crow::response& res, int code, double retry_after_seconds, const std::string& message) {
+    res.code = code;
+    res.set_header("Retry-After", std::to_string(std::max(1, int(std::ceil(retry_after_seconds)))));
+    res.body = message;
+    res.end();
+}
+
+} // namespace
+
+struct AdmissionMiddleware::State {
+    const DataStore* store;
+    Limits limits;
+    std::array<size_t, kClasses> max_in_flight;
+    std::array<std::atomic<size_t>, kClasses> in_flight{};
+    std::array<BucketShard, kBucketShards> shards;
+
+    // Take `units` from the client's bucket. Returns 0 when paid, else the
+    // seconds until it could be. Costs above the burst size are capped so
+    // that large requests remain possible from a full bucket.
+    double charge(const std::string& client, double units) {
+        units = std::min(units, limits.client_burst);
+        auto& shard = shards[std::hash<std::string>{}(client) % kBucketShards];
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // Forget idle clients (full buckets) before the table grows unbounded
+        if (shard.buckets.size() >= kMaxBucketsPerShard) {
+            for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+                double idle = std::chrono::duration<double>(now - it->second.refilled).count();
+                bool full = it->second.tokens + idle * limits.client_rate >= limits.client_burst;
+                it = full ? shard.buckets.erase(it) : std::next(it);
+            }
+        }
+
+        auto [it, inserted] = shard.buckets.try_emplace(client, Bucket{limits.client_burst, now});
+        Bucket& bucket = it->second;
+        double elapsed = std::chrono::duration<double>(now - bucket.refilled).count();
+        bucket.tokens = std::min(limits.client_burst, bucket.tokens + elapsed * limits.client_rate);
+        bucket.refilled = now;
+
+        if (bucket.tokens < units) {
+            return (units - bucket.tokens) / limits.client_rate;
+        }
+        bucket.tokens -= units;
+        return 0.0;
+    }
+};
+
+AdmissionMiddleware::Limits::Limits()
+    : medium_concurrency(2 * utils::default_parallelism()),
+      heavy_concurrency(std::max<size_t>(1, utils::default_parallelism() / 2)) {}
+
+void AdmissionMiddleware::configure(const DataStore& store, const Limits& limits) {
+    auto state = std::make_shared<State>();
+    state->store = &store;
+    state->limits = limits;
+    state->max_in_flight = {0, limits.medium_concurrency, limits.heavy_concurrency};
+    state_ = std::move(state);
+}
+
+void AdmissionMiddleware::before_handle(crow::request& req, crow::response& res, context& ctx) {
+    if (!state_) return;
+    auto estimate = admission::estimate_cost(req, *state_->store);
+    int slot = static_cast<int>(estimate.cost_class);
+
+    size_t limit = state_->max_in_flight[slot];
+    size_t running = state_->in_flight[slot].fetch_add(1);
+    if (limit > 0 && running >= limit) {
+        state_->in_flight[slot].fetch_sub(1);
+        rejected_counter(estimate.cost_class, "concurrency").inc();
+        reject(res, 503, 1.0, "Server busy, retry later");
+        return;
+    }
+
+    double wait = state_->charge(req.remote_ip_address, static_cast<double>(estimate.units));
+    if (wait > 0.0) {
+        state_->in_flight[slot].fetch_sub(1);
+        rejected_counter(estimate.cost_class, "rate").inc();
+        reject(res, 429, wait, "Too many requests");
+        return;
+    }
+
+    ctx.admitted = true;
+    ctx.cost_class = estimate.cost_class;
+}
+
+void AdmissionMiddleware::after_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+    if (ctx.admitted) {
+        state_->in_flight[static_cast<int>(ctx.cost_class)].fetch_sub(1);
+        ctx.admitted = false;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "crow.h"
+#include "cost_model.hpp"
+#include "../database/data_store.hpp"
+#include <cstddef>
+#include <memory>
+
+// Admission control in front of the handlers. Every request's cost is
+// estimated before it runs (see cost_model.hpp), then:
+//  - its cost class must have a free concurrency slot, else 503;
+//  - its client (remote IP) must be able to pay the cost from a token
+//    bucket refilled at client_rate units/s up to client_burst, else 429.
+// Both rejections carry Retry-After. Cheap requests have no concurrency
+// limit, so lookups keep flowing while expensive work is shed.
+//
+// Registered after MetricsMiddleware so shed requests are still counted.
+struct AdmissionMiddleware {
+    struct Limits {
+        double client_rate = 200000;   // Cost units per second per client
+        double client_burst = 1000000;
+        size_t medium_concurrency;     // 0 = unlimited
+        size_t heavy_concurrency;
+
+        Limits();
+    };
+
+    struct context {
+        bool admitted = false;
+        admission::CostClass cost_class = admission::CostClass::Cheap;
+    };
+
+    // Everything is admitted until a store is configured
+    void configure(const DataStore& store, const Limits& limits);
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+private:
+    struct State;
+    std::shared_ptr<State> state_;
+};
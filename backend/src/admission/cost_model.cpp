@@ -0,0 +1,70 @@
+#include "cost_model.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+
+namespace admission {
+
+namespace {
+
+uint64_t one_hop_cost(const crow::request& req, const DataStore::ReadView& view) {
+    auto source_param = req.url_params.get("source");
+    auto dest_param = req.url_params.get("dest");
+    if (!source_param || !dest_param) return 1;
+
+    auto source = view.airport_by_iata(source_param);
+    auto dest = view.airport_by_iata(dest_param);
+    if (!source || !dest) return 1;
+
+    int min_legs = view.hop_lower_bound(*source, *dest);
+    if (min_legs < 0 || min_legs > 2) return 1;
+
+    const auto& stats = view.analytics().airport_stats();
+    auto it = stats.find(source->id);
+    if (it == stats.end()) return 1;
+
+    double mean_routes = stats.empty() ? 0.0 : double(view.route_count()) / stats.size();
+    return std::max<uint64_t>(1, static_cast<uint64_t>(it->second.routes_out * mean_routes));
+}
+
+} // namespace
+
+const char* class_name(CostClass cost_class) {
+    switch (cost_class) {
+        case CostClass::Cheap: return "cheap";
+        case CostClass::Medium: return "medium";
+        case CostClass::Heavy: return "heavy";
+        case CostClass::Count: break;
+    }
+    return "unknown";
+}
+
+CostEstimate estimate_cost(const crow::request& req, const DataStore& store) {
+    CostEstimate estimate;
+    std::string path = req.url.substr(0, req.url.find('?'));
+    if (req.method == crow::HTTPMethod::POST && path == "/api/versions/pin") {
+        // The first pin of a version copies every table and rebuilds its indexes
+        estimate.units = store.get_airport_count() + store.get_airline_count() + store.get_route_count();
+    } else if (req.method != crow::HTTPMethod::GET) {
+        return estimate;
+    } else if (path == "/api/routes/one-hop") {
+        estimate.units = one_hop_cost(req, store.read());
+    } else if (path == "/api/airports" || path == "/api/export/airports.csv") {
+        estimate.units = store.get_airport_count();
+    } else if (path == "/api/airlines" || path == "/api/export/airlines.csv") {
+        estimate.units = store.get_airline_count();
+    } else if (path == "/api/export/routes.csv") {
+        estimate.units = store.get_route_count();
+    } else if (path == "/api/routes") {
+        auto limit = req.url_params.get("limit");
+        estimate.units = limit ? std::clamp(utils::safe_stoi(limit), 1, 10000) : 1000;
+    }
+
+    if (estimate.units >= kHeavyCost) {
+        estimate.cost_class = CostClass::Heavy;
+    } else if (estimate.units >= kMediumCost) {
+        estimate.cost_class = CostClass::Medium;
+    }
+    return estimate;
+}
+
+} // namespace admission
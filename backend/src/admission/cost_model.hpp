@@ -0,0 +1,34 @@
+#pragma once
+#include "crow.h"
+#include "../database/data_store.hpp"
+#include <cstdint>
+
+// Up-front cost estimates for admission control. A request's cost is the
+// number of rows/edges it is expected to touch, derived from O(1) store
+// statistics before the handler runs:
+//
+//   one-hop         source routes x mean routes per airport (0 legs when
+//                   the reachability labeling already rules it out)
+//   full lists      table size
+//   CSV exports     table size
+//   route filter    requested page size
+//   version pin     every table's size (the first pin copies the store)
+//   everything else 1
+namespace admission {
+
+enum class CostClass { Cheap, Medium, Heavy, Count };
+
+const char* class_name(CostClass cost_class);
+
+struct CostEstimate {
+    uint64_t units = 1;
+    CostClass cost_class = CostClass::Cheap;
+};
+
+// Class boundaries in cost units
+constexpr uint64_t kMediumCost = 500;
+constexpr uint64_t kHeavyCost = 10000;
+
+CostEstimate estimate_cost(const crow::request& req, const DataStore& store);
+
+} // namespace admission
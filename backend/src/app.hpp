@@ -0,0 +1,13 @@
+#pragma once
+#include "crow.h"
+#include "crow/middlewares/cors.h"
+#include "admission/admission_middleware.hpp"
+#include "compression/compression_middleware.hpp"
+#include "encoding/msgpack_middleware.hpp"
+#include "metrics/metrics_middleware.hpp"
+#include "replication/read_only_middleware.hpp"
+
+// Application type shared by the server and all handlers.
+// Middlewares run before_handle in this order and after_handle in reverse.
+using FlightApp = crow::App<MetricsMiddleware, ReadOnlyMiddleware, AdmissionMiddleware,
+                            CompressionMiddleware, MsgpackMiddleware, crow::CORSHandler>;
@@ -0,0 +1,106 @@
+#include "codec.hpp"
+#include <zlib.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace compression {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+// q-value of one "coding;q=0.5" element; 1 when absent
+double quality(std::string_view params) {
+    while (!params.empty()) {
+        size_t semi = params.find(';');
+        std::string_view param = trim(params.substr(0, semi));
+        params = semi == std::string_view::npos ? std::string_view() : params.substr(semi + 1);
+        if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+            return std::strtod(std::string(param.substr(2)).c_str(), nullptr);
+        }
+    }
+    return 1.0;
+}
+
+} // namespace
+
+const char* encoding_name(Encoding encoding) {
+    switch (encoding) {
+        case Encoding::Identity: return "identity";
+        case Encoding::Gzip: return "gzip";
+        case Encoding::Deflate: return "deflate";
+        case Encoding::Count: break;
+    }
+    return "identity";
+}
+
+Encoding negotiate(const std::string& accept_encoding) {
+    // -1 = not mentioned; "*" fills in whatever is not named explicitly
+    double gzip = -1, deflate = -1, any = -1;
+
+    std::string_view rest = accept_encoding;
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view element = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        size_t semi = element.find(';');
+        std::string_view coding = trim(element.substr(0, semi));
+        double q = semi == std::string_view::npos ? 1.0 : quality(element.substr(semi + 1));
+
+        if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+            gzip = q;
+        } else if (iequals(coding, "deflate")) {
+            deflate = q;
+        } else if (coding == "*") {
+            any = q;
+        }
+    }
+    if (gzip < 0) gzip = any;
+    if (deflate < 0) deflate = any;
+
+    if (gzip > 0 && gzip >= deflate) return Encoding::Gzip;
+    if (deflate > 0) return Encoding::Deflate;
+    return Encoding::Identity;
+}
+
+std::string compress(std::string_view data, Encoding encoding, int level) {
+    if (encoding != Encoding::Gzip && encoding != Encoding::Deflate) {
+        return std::string(data);
+    }
+
+    z_stream stream{};
+    // windowBits 15 for zlib framing, +16 for a gzip header/trailer instead
+    int window_bits = encoding == Encoding::Gzip ? 15 + 16 : 15;
+    if (deflateInit2(&stream, std::clamp(level, 1, 9), Z_DEFLATED, window_bits, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::string();
+    }
+
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    // The output buffer is sized by deflateBound, so one call finishes
+    int status = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END ? out : std::string();
+}
+
+} // namespace compression
@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// HTTP content codings backed by zlib.
+//
+// "deflate" is the zlib-wrapped stream (RFC 1950), which is what HTTP
+// means by it; raw deflate is not produced.
+namespace compression {
+
+enum class Encoding { Identity, Gzip, Deflate, Count };
+
+// Content-Encoding token ("identity", "gzip", "deflate")
+const char* encoding_name(Encoding encoding);
+
+// Pick the best coding the client accepts from an Accept-Encoding header.
+// Honours q-values and "*"; prefers gzip over deflate on a tie and falls
+// back to identity when nothing compressed is acceptable.
+Encoding negotiate(const std::string& accept_encoding);
+
+// zlib level 1 (fast) to 9 (small). Identity returns the input unchanged.
+std::string compress(std::string_view data, Encoding encoding, int level = 6);
+
+} // namespace compression
@@ -0,0 +1,55 @@
+#include "compression_middleware.hpp"
+#include "../metrics/metrics.hpp"
+
+using compression::Encoding;
+
+namespace {
+
+struct EncodingCounters {
+    metrics::Counter input;
+    metrics::Counter output;
+};
+
+const EncodingCounters& counters(Encoding encoding) {
+    static const EncodingCounters gzip{
+        metrics::counter("flight_compression_input_bytes_total", "encoding=\"gzip\"",
+                         "Response bytes before on-the-fly compression"),
+        metrics::counter("flight_compression_output_bytes_total", "encoding=\"gzip\"",
+                         "Response bytes after on-the-fly compression")};
+    static const EncodingCounters deflate{
+        metrics::counter("flight_compression_input_bytes_total", "encoding=\"deflate\"",
+                         "Response bytes before on-the-fly compression"),
+        metrics::counter("flight_compression_output_bytes_total", "encoding=\"deflate\"",
+                         "Response bytes after on-the-fly compression")};
+    return encoding == Encoding::Gzip ? gzip : deflate;
+}
+
+} // namespace
+
+void CompressionMiddleware::configure(size_t min_size, int level) {
+    enabled_ = true;
+    min_size_ = min_size;
+    level_ = level;
+}
+
+void CompressionMiddleware::before_handle(crow::request& req, crow::response& /*res*/, context& ctx) {
+    if (enabled_) {
+        ctx.encoding = compression::negotiate(req.get_header_value("Accept-Encoding"));
+    }
+}
+
+void CompressionMiddleware::after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+    if (ctx.encoding == Encoding::Identity) return;
+    if (res.body.size() < min_size_ || !res.get_header_value("Content-Encoding").empty()) return;
+
+    std::string compressed = compression::compress(res.body, ctx.encoding, level_);
+    if (compressed.empty() || compressed.size() >= res.body.size()) return;
+
+    const auto& series = counters(ctx.encoding);
+    series.input.inc(res.body.size());
+    series.output.inc(compressed.size());
+
+    res.body = std::move(compressed);
+    res.set_header("Content-Encoding", compression::encoding_name(ctx.encoding));
+    res.add_header("Vary", "Accept-Encoding");
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "crow.h"
+#include "codec.hpp"
+#include <cstddef>
+
+// Compresses response bodies on the fly for clients that accept gzip or
+// deflate. Small bodies are sent as-is: below `min_size` the CPU spent
+// outweighs the bytes saved. Responses that already carry a
+// Content-Encoding (see PrecompressedResponse) are passed through.
+//
+// Registered after MetricsMiddleware so the size histogram sees the bytes
+// actually sent.
+struct CompressionMiddleware {
+    struct context {
+        compression::Encoding encoding = compression::Encoding::Identity;
+    };
+
+    // Off until configured
+    void configure(size_t min_size, int level);
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+private:
+    bool enabled_ = false;
+    size_t min_size_ = 1024;
+    int level_ = 6;
+};
@@ -0,0 +1,68 @@
+#include "precompressed_response.hpp"
+#include "../metrics/metrics.hpp"
+
+using compression::Encoding;
+
+crow::response PrecompressedResponse::serve(const std::string& accept_encoding, uint64_t generation,
+                                            uint64_t version, const utils::Deadline& deadline,
+                                            const Build& build) {
+    static const auto hits = metrics::counter(
+        "flight_precompressed_total", "result=\"hit\"", "Precompressed response lookups");
+    static const auto misses = metrics::counter(
+        "flight_precompressed_total", "result=\"miss\"", "Precompressed response lookups");
+
+    Encoding encoding = compression::negotiate(accept_encoding);
+    Key key{generation, version};
+    Body body = lookup(key, encoding);
+
+    if (body) {
+        hits.inc();
+    } else {
+        misses.inc();
+        Body identity = lookup(key, Encoding::Identity);
+        if (!identity) {
+            identity = std::make_shared<const std::string>(build());
+            if (deadline.expired()) return crow::response(504);
+            store(key, Encoding::Identity, identity);
+        }
+
+        body = identity;
+        if (encoding != Encoding::Identity) {
+            auto compressed = compression::compress(*identity, encoding, level_);
+            if (compressed.empty()) {
+                encoding = Encoding::Identity;
+            } else {
+                body = std::make_shared<const std::string>(std::move(compressed));
+                store(key, encoding, body);
+            }
+        }
+    }
+
+    crow::response res(200, *body);
+    res.set_header("Content-Type", content_type_);
+    res.set_header("Vary", "Accept-Encoding");
+    if (encoding != Encoding::Identity) {
+        res.set_header("Content-Encoding", compression::encoding_name(encoding));
+    }
+    return res;
+}
+
+PrecompressedResponse::Body PrecompressedResponse::lookup(const Key& key, Encoding encoding) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!valid_ || key_ != key) return nullptr;
+    return bodies_[static_cast<size_t>(encoding)];
+}
+
+void PrecompressedResponse::store(const Key& key, Encoding encoding, Body body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A slow reader must not replace a newer version with an older one. A
+    // version number can repeat after a change-log reset, so the
+    // generation comes first.
+    if (valid_ && key < key_) return;
+    if (!valid_ || key != key_) {
+        bodies_.fill(nullptr);
+        key_ = key;
+        valid_ = true;
+    }
+    bodies_[static_cast<size_t>(encoding)] = std::move(body);
+}
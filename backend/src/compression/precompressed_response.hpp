@@ -0,0 +1,48 @@
+#pragma once
+#include "crow.h"
+#include "codec.hpp"
+#include "../utils/deadline.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// A large response body that only changes with the data version (e.g. the
+// full airport list). The body is built once per version and each encoding
+// is compressed once, on first request, then served from memory.
+//
+// Bodies built past their deadline may be partial and are never stored.
+class PrecompressedResponse {
+public:
+    using Build = std::function<std::string()>;
+
+    explicit PrecompressedResponse(std::string content_type = "application/json", int level = 6)
+        : content_type_(std::move(content_type)), level_(level) {}
+
+    // Response for `version` of change-log `generation` in the best coding
+    // `accept_encoding` allows; `build` runs only on a miss and must
+    // produce the identity body, of this response's content type, for that
+    // version.
+    crow::response serve(const std::string& accept_encoding, uint64_t generation, uint64_t version,
+                         const utils::Deadline& deadline, const Build& build);
+
+private:
+    using Body = std::shared_ptr<const std::string>;
+    static constexpr size_t kEncodings = static_cast<size_t>(compression::Encoding::Count);
+
+    // (generation, version), ordered oldest first
+    using Key = std::pair<uint64_t, uint64_t>;
+
+    Body lookup(const Key& key, compression::Encoding encoding);
+    void store(const Key& key, compression::Encoding encoding, Body body);
+
+    std::string content_type_;
+    int level_;
+    std::mutex mutex_;
+    Key key_;
+    bool valid_ = false;
+    std::array<Body, kEncodings> bodies_;  // Indexed by Encoding, null until built
+};
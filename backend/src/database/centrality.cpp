@@ -0,0 +1,223 @@
+#include "centrality.hpp"
+#include "../utils/parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr double kDamping = 0.85;
+constexpr int kMaxIterations = 100;
+constexpr double kTolerance = 1e-9;
+
+// Route graph over dense node indexes, in both directions
+struct Graph {
+    std::vector<int> airport_ids;  // node -> airport id
+
+    // CSR adjacency: distinct neighbours with route multiplicity as weight
+    std::vector<size_t> out_offsets, in_offsets;
+    std::vector<int> out_targets, in_sources;
+    std::vector<double> in_weights;
+    std::vector<double> out_weight;  // Total routes leaving each node
+};
+
+Graph build_graph(const std::vector<std::pair<int, int>>& edges) {
+    Graph graph;
+    std::unordered_map<int, int> node_of;
+    auto node = [&](int airport_id) {
+        auto [it, inserted] = node_of.emplace(airport_id, static_cast<int>(graph.airport_ids.size()));
+        if (inserted) graph.airport_ids.push_back(airport_id);
+        return it->second;
+    };
+
+    // Collapse parallel routes into weighted edges
+    std::vector<std::pair<std::pair<int, int>, double>> weighted;
+    weighted.reserve(edges.size());
+    for (const auto& [source, dest] : edges) {
+        weighted.push_back({{node(source), node(dest)}, 1.0});
+    }
+    std::sort(weighted.begin(), weighted.end());
+    size_t unique = 0;
+    for (size_t i = 0; i < weighted.size(); ++i) {
+        if (unique > 0 && weighted[unique - 1].first == weighted[i].first) {
+            weighted[unique - 1].second += 1.0;
+        } else {
+            weighted[unique++] = weighted[i];
+        }
+    }
+    weighted.resize(unique);
+
+    size_t n = graph.airport_ids.size();
+    graph.out_offsets.assign(n + 1, 0);
+    graph.in_offsets.assign(n + 1, 0);
+    graph.out_weight.assign(n, 0.0);
+    for (const auto& [edge, weight] : weighted) {
+        graph.out_offsets[edge.first + 1]++;
+        graph.in_offsets[edge.second + 1]++;
+        graph.out_weight[edge.first] += weight;
+    }
+    for (size_t v = 0; v < n; ++v) {
+        graph.out_offsets[v + 1] += graph.out_offsets[v];
+        graph.in_offsets[v + 1] += graph.in_offsets[v];
+    }
+
+    graph.out_targets.resize(unique);
+    graph.in_sources.resize(unique);
+    graph.in_weights.resize(unique);
+    std::vector<size_t> out_fill(graph.out_offsets.begin(), graph.out_offsets.end() - 1);
+    std::vector<size_t> in_fill(graph.in_offsets.begin(), graph.in_offsets.end() - 1);
+    for (const auto& [edge, weight] : weighted) {
+        graph.out_targets[out_fill[edge.first]++] = edge.second;
+        size_t slot = in_fill[edge.second]++;
+        graph.in_sources[slot] = edge.first;
+        graph.in_weights[slot] = weight;
+    }
+    return graph;
+}
+
+std::vector<double> pagerank(const Graph& graph, utils::Executor& pool, size_t workers) {
+    size_t n = graph.airport_ids.size();
+    std::vector<double> rank(n, 1.0 / n), next(n);
+
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        // Rank held by nodes without outgoing routes is spread evenly
+        double dangling = 0.0;
+        for (size_t v = 0; v < n; ++v) {
+            if (graph.out_weight[v] == 0.0) dangling += rank[v];
+        }
+        double base = (1.0 - kDamping) / n + kDamping * dangling / n;
+
+        std::vector<double> chunk_delta(workers, 0.0);
+        size_t used = utils::parallel_chunks(pool, n, workers, [&](size_t chunk, size_t begin, size_t end) {
+            double delta = 0.0;
+            for (size_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (size_t e = graph.in_offsets[v]; e < graph.in_offsets[v + 1]; ++e) {
+                    int u = graph.in_sources[e];
+                    sum += rank[u] * graph.in_weights[e] / graph.out_weight[u];
+                }
+                next[v] = base + kDamping * sum;
+                delta += std::abs(next[v] - rank[v]);
+            }
+            chunk_delta[chunk] = delta;
+        });
+
+        rank.swap(next);
+        double delta = 0.0;
+        for (size_t c = 0; c < used; ++c) delta += chunk_delta[c];
+        if (delta < kTolerance) break;
+    }
+    return rank;
+}
+
+// Brandes' dependency accumulation from each sampled source (unweighted
+// shortest paths), summed over sources
+std::vector<double> sampled_betweenness(const Graph& graph, const std::vector<int>& sources,
+                                        utils::Executor& pool, size_t workers) {
+    size_t n = graph.airport_ids.size();
+    std::vector<std::vector<double>> partial(workers);
+
+    size_t used = utils::parallel_chunks(pool, sources.size(), workers,
+        [&](size_t chunk, size_t begin, size_t end) {
+            auto& centrality = partial[chunk];
+            centrality.assign(n, 0.0);
+            std::vector<int> distance(n), order;
+            std::vector<double> paths(n), dependency(n);
+            order.reserve(n);
+
+            for (size_t i = begin; i < end; ++i) {
+                int source = sources[i];
+                std::fill(distance.begin(), distance.end(), -1);
+                std::fill(paths.begin(), paths.end(), 0.0);
+                std::fill(dependency.begin(), dependency.end(), 0.0);
+                order.clear();
+
+                distance[source] = 0;
+                paths[source] = 1.0;
+                order.push_back(source);
+                for (size_t head = 0; head < order.size(); ++head) {
+                    int v = order[head];
+                    for (size_t e = graph.out_offsets[v]; e < graph.out_offsets[v + 1]; ++e) {
+                        int w = graph.out_targets[e];
+                        if (distance[w] < 0) {
+                            distance[w] = distance[v] + 1;
+                            order.push_back(w);
+                        }
+                        if (distance[w] == distance[v] + 1) paths[w] += paths[v];
+                    }
+                }
+
+                // Walk back from the farthest nodes; predecessors are the
+                // in-neighbours one step closer to the source
+                for (size_t k = order.size(); k-- > 1;) {
+                    int w = order[k];
+                    for (size_t e = graph.in_offsets[w]; e < graph.in_offsets[w + 1]; ++e) {
+                        int v = graph.in_sources[e];
+                        if (distance[v] >= 0 && distance[v] + 1 == distance[w]) {
+                            dependency[v] += paths[v] / paths[w] * (1.0 + dependency[w]);
+                        }
+                    }
+                    centrality[w] += dependency[w];
+                }
+            }
+        });
+
+    std::vector<double> total(n, 0.0);
+    for (size_t c = 0; c < used; ++c) {
+        for (size_t v = 0; v < partial[c].size(); ++v) total[v] += partial[c][v];
+    }
+    return total;
+}
+
+// Airport ids ordered by descending score
+std::vector<int> ranking(const Graph& graph, const std::vector<double>& score) {
+    std::vector<int> nodes(score.size());
+    for (size_t v = 0; v < nodes.size(); ++v) nodes[v] = static_cast<int>(v);
+    std::sort(nodes.begin(), nodes.end(), [&](int a, int b) {
+        return score[a] != score[b] ? score[a] > score[b]
+                                    : graph.airport_ids[a] < graph.airport_ids[b];
+    });
+    for (auto& v : nodes) v = graph.airport_ids[v];
+    return nodes;
+}
+
+} // namespace
+
+CentralityScores compute_centrality(const std::vector<std::pair<int, int>>& edges,
+                                    size_t samples, utils::Executor& pool) {
+    auto start = std::chrono::steady_clock::now();
+    CentralityScores scores;
+    Graph graph = build_graph(edges);
+    size_t n = graph.airport_ids.size();
+    if (n == 0) return scores;
+    // The pool's workers plus the calling thread
+    size_t workers = pool.workers() + 1;
+
+    auto rank = pagerank(graph, pool, workers);
+
+    // Evenly spaced sources; the estimate is scaled up by n / samples
+    samples = std::min(std::max<size_t>(1, samples), n);
+    std::vector<int> sources;
+    for (size_t i = 0; i < samples; ++i) {
+        sources.push_back(static_cast<int>(i * n / samples));
+    }
+    auto betweenness = sampled_betweenness(graph, sources, pool, workers);
+    double normalize = n > 2 ? double(n) / samples / ((n - 1.0) * (n - 2.0)) : 0.0;
+
+    scores.sampled_sources = samples;
+    scores.by_pagerank = ranking(graph, rank);
+    scores.by_betweenness = ranking(graph, betweenness);
+    for (size_t v = 0; v < n; ++v) {
+        auto& airport = scores.airports[graph.airport_ids[v]];
+        airport.pagerank = rank[v];
+        airport.betweenness = betweenness[v] * normalize;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        scores.airports[scores.by_pagerank[i]].pagerank_rank = static_cast<int>(i + 1);
+        scores.airports[scores.by_betweenness[i]].betweenness_rank = static_cast<int>(i + 1);
+    }
+
+    scores.compute_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return scores;
+}
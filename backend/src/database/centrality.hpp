@@ -0,0 +1,33 @@
+#pragma once
+#include "../utils/executor.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct AirportCentrality {
+    double pagerank = 0.0;
+    double betweenness = 0.0;  // Normalized to [0, 1], estimated from sampled sources
+    int pagerank_rank = 0;     // 1 = most central
+    int betweenness_rank = 0;
+};
+
+// One published centrality result. Immutable once built; readers hold it
+// through a shared_ptr, so a new result never disturbs one in use.
+struct CentralityScores {
+    uint64_t version = 0;     // Change-log sequence the route graph was taken at
+    uint64_t generation = 0;  // ... and the change log's generation then
+    std::unordered_map<int, AirportCentrality> airports;
+    std::vector<int> by_pagerank;     // Airport ids, most central first
+    std::vector<int> by_betweenness;
+    size_t sampled_sources = 0;
+    double compute_seconds = 0.0;
+};
+
+// PageRank (weighted by routes per airport pair) and Brandes betweenness
+// from `samples` evenly spaced source airports. `edges` holds one
+// (source, dest) airport id pair per route. Work is split between the
+// calling thread and `pool`'s workers; the caller must not be one of them.
+CentralityScores compute_centrality(const std::vector<std::pair<int, int>>& edges,
+                                    size_t samples, utils::Executor& pool);
@@ -0,0 +1,80 @@
+#include "centrality_job.hpp"
+#include "../metrics/metrics.hpp"
+#include "../utils/parallel.hpp"
+
+CentralityJob::CentralityJob(DataStore& store, size_t samples, std::chrono::milliseconds settle)
+    : store_(store), samples_(samples), settle_(settle),
+      // The job's own thread takes a share of each run too
+      pool_(std::max<size_t>(1, utils::default_parallelism() - 1)) {}
+
+CentralityJob::~CentralityJob() {
+    stop();
+}
+
+void CentralityJob::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void CentralityJob::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void CentralityJob::run() {
+    const ChangeLog& log = store_.get_change_log();
+    uint64_t computed_at = compute();
+    uint64_t generation = log.generation();
+    while (running_) {
+        // Short waits so stop() is honoured promptly. A reset (a replica
+        // reloading a snapshot) can lower the sequence, so it never shows
+        // up as a newer one.
+        if (!log.wait_for(computed_at, std::chrono::milliseconds(500)) &&
+            log.generation() == generation) {
+            continue;
+        }
+
+        // Let a burst of writes finish before paying for a run, but do not
+        // let a steady write stream postpone it forever
+        auto deadline = std::chrono::steady_clock::now() + settle_ * 5;
+        uint64_t seen = log.current_seq();
+        while (running_ && std::chrono::steady_clock::now() < deadline &&
+               log.wait_for(seen, settle_)) {
+            seen = log.current_seq();
+        }
+        if (!running_) break;
+
+        generation = log.generation();
+        computed_at = compute();
+    }
+}
+
+uint64_t CentralityJob::compute() {
+    static const auto compute_time = metrics::histogram(
+        "flight_centrality_compute_seconds", "", "PageRank + sampled betweenness run time", 1e-6);
+    metrics::ScopedTimer timer(compute_time);
+
+    // Copy the edge list and release the lock before the heavy part
+    std::vector<std::pair<int, int>> edges;
+    uint64_t version, generation;
+    {
+        auto view = store_.read();
+        version = view.version();
+        generation = view.generation();
+        for (const Route* route : view.filter_routes(RouteFilter{})) {
+            // Routes to airports missing from airports.csv (id "\N") would
+            // otherwise all meet at one phantom hub
+            if (view.airport_by_id(route->source_airport_id) &&
+                view.airport_by_id(route->dest_airport_id)) {
+                edges.emplace_back(route->source_airport_id, route->dest_airport_id);
+            }
+        }
+    }
+
+    auto scores = std::make_shared<CentralityScores>(
+        compute_centrality(edges, samples_, pool_));
+    scores->version = version;
+    scores->generation = generation;
+    store_.publish_centrality(std::move(scores));
+    return version;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "data_store.hpp"
+#include "../utils/executor.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Background thread that keeps DataStore's published centrality current.
+// It waits on the change log and, once mutations have stopped arriving
+// for `settle`, snapshots the route graph under a read lock and
+// recomputes off-lock, so bursts of writes cost one run. Runs split their
+// work over a pool kept for the job's lifetime.
+class CentralityJob {
+public:
+    explicit CentralityJob(DataStore& store, size_t samples = 256,
+                           std::chrono::milliseconds settle = std::chrono::milliseconds(2000));
+    ~CentralityJob();
+
+    void start();
+    void stop();
+
+private:
+    void run();
+    // Returns the data version the published result reflects
+    uint64_t compute();
+
+    DataStore& store_;
+    size_t samples_;
+    std::chrono::milliseconds settle_;
+    std::atomic<bool> running_{false};
+    utils::Executor pool_;
+    std::thread thread_;
+};
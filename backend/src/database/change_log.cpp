@@ -0,0 +1,126 @@
+#include "change_log.hpp"
+#include <algorithm>
+
+const char* to_string(ChangeOp op) {
+    switch (op) {
+        case ChangeOp::Insert: return "insert";
+        case ChangeOp::Update: return "update";
+        case ChangeOp::Delete: return "delete";
+    }
+    return "unknown";
+}
+
+const char* to_string(ChangeEntity entity) {
+    switch (entity) {
+        case ChangeEntity::Airport: return "airport";
+        case ChangeEntity::Airline: return "airline";
+        case ChangeEntity::Route: return "route";
+    }
+    return "unknown";
+}
+
+crow::json::wvalue ChangeEvent::to_json() const {
+    crow::json::wvalue json;
+    json["seq"] = seq;
+    json["op"] = to_string(op);
+    json["entity"] = to_string(entity);
+    json["key"] = key;
+    if (!data.empty()) {
+        json["data"] = crow::json::load(data);
+    }
+    return json;
+}
+
+std::string ChangeEvent::to_sse() const {
+    // Keys are numeric ids or "<aid>_<sid>_<did>", so no escaping is needed
+    std::string msg;
+    msg.reserve(data.size() + 96);
+    msg += "id: " + std::to_string(seq) + "\n";
+    msg += "event: " + std::string(to_string(entity)) + "." + to_string(op) + "\n";
+    msg += "data: {\"seq\":" + std::to_string(seq) +
+           ",\"op\":\"" + to_string(op) +
+           "\",\"entity\":\"" + to_string(entity) +
+           "\",\"key\":\"" + key + "\"";
+    if (!data.empty()) {
+        msg += ",\"data\":" + data;
+    }
+    msg += "}\n\n";
+    return msg;
+}
+
+ChangeLog::ChangeLog(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+    ring_.resize(capacity_);
+}
+
+uint64_t ChangeLog::append(ChangeOp op, ChangeEntity entity, std::string key, std::string data,
+                           bool partial) {
+    uint64_t seq;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        seq = ++last_seq_;
+        ring_[seq % capacity_] = ChangeEvent{seq, op, entity, std::move(key), std::move(data), partial};
+    }
+    cv_.notify_all();
+    notify_listeners();
+    return seq;
+}
+
+bool ChangeLog::read_since(uint64_t since, size_t limit, std::vector<ChangeEvent>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (since + 1 < oldest_locked()) {
+        return false;
+    }
+
+    for (uint64_t seq = since + 1; seq <= last_seq_ && out.size() < limit; ++seq) {
+        out.push_back(ring_[seq % capacity_]);
+    }
+    return true;
+}
+
+bool ChangeLog::wait_for(uint64_t since, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [&] { return last_seq_ > since; });
+}
+
+void ChangeLog::add_listener(Listener listener) const {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    listeners_.push_back(std::move(listener));
+}
+
+void ChangeLog::notify_listeners() const {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    for (const auto& listener : listeners_) listener();
+}
+
+uint64_t ChangeLog::current_seq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_seq_;
+}
+
+uint64_t ChangeLog::oldest_seq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (last_seq_ == base_seq_) return 0;
+    return oldest_locked();
+}
+
+void ChangeLog::reset(uint64_t seq) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::fill(ring_.begin(), ring_.end(), ChangeEvent{});
+        last_seq_ = seq;
+        base_seq_ = seq;
+        ++generation_;
+    }
+    cv_.notify_all();
+    notify_listeners();
+}
+
+uint64_t ChangeLog::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+uint64_t ChangeLog::oldest_locked() const {
+    uint64_t oldest = last_seq_ >= capacity_ ? last_seq_ - capacity_ + 1 : 1;
+    return std::max(oldest, base_seq_ + 1);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "crow.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class ChangeOp { Insert, Update, Delete };
+enum class ChangeEntity { Airport, Airline, Route };
+
+const char* to_string(ChangeOp op);
+const char* to_string(ChangeEntity entity);
+
+// A single committed DataStore mutation
+struct ChangeEvent {
+    uint64_t seq;
+    ChangeOp op;
+    ChangeEntity entity;
+    std::string key;   // Airport/airline id, or Route::get_key()
+    std::string data;  // JSON of the entity after the change (empty for deletes)
+    // Set on the leading events of a mutation that logs several: the route
+    // deletes of an airport/airline removal and the delete half of a route
+    // re-key. The mutation's last event is not partial.
+    bool partial = false;
+
+    // Convert to JSON for API responses
+    crow::json::wvalue to_json() const;
+
+    // Serialized as one Server-Sent Events message
+    std::string to_sse() const;
+};
+
+// Bounded ring of recent mutations, numbered by a monotonically increasing
+// sequence. Sequence numbers start at 1; 0 means "nothing seen yet".
+class ChangeLog {
+public:
+    explicit ChangeLog(size_t capacity = 65536);
+
+    uint64_t append(ChangeOp op, ChangeEntity entity, std::string key, std::string data = "",
+                    bool partial = false);
+
+    // Events with seq > since, oldest first, at most `limit` of them.
+    // Returns false if `since` has already fallen out of the ring, in which
+    // case the caller has missed events and must resync from the full lists.
+    bool read_since(uint64_t since, size_t limit, std::vector<ChangeEvent>& out) const;
+
+    // Block until an event newer than `since` exists or the timeout expires
+    bool wait_for(uint64_t since, std::chrono::milliseconds timeout) const;
+
+    // Called after every append() and reset(), outside the log's lock, for
+    // waiters that cannot block a thread in wait_for(). Keep it cheap: it
+    // runs on the writer's thread.
+    using Listener = std::function<void()>;
+    void add_listener(Listener listener) const;
+
+    uint64_t current_seq() const;
+    uint64_t oldest_seq() const;
+
+    // Drop every buffered event and continue numbering after `seq`. A
+    // replica calls this after loading a primary's snapshot so that its
+    // sequence numbers match the primary's.
+    void reset(uint64_t seq);
+
+    // Bumped by every reset(). After one, a sequence number may be reused
+    // for different data, so anything keyed by version keys by both.
+    uint64_t generation() const;
+
+private:
+    uint64_t oldest_locked() const;
+    void notify_listeners() const;
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+    std::vector<ChangeEvent> ring_;
+    size_t capacity_;
+    uint64_t last_seq_ = 0;
+    uint64_t base_seq_ = 0;  // Events up to here were never buffered
+    uint64_t generation_ = 0;
+
+    mutable std::mutex listeners_mutex_;
+    mutable std::vector<Listener> listeners_;
+};
@@ -0,0 +1,64 @@
+#include "code_index.hpp"
+#include <algorithm>
+
+void CodeIndex::build(const std::vector<std::pair<uint32_t, int>>& entries) {
+    // Keep the load factor at or below 1/2 so probe sequences stay short
+    uint32_t bits = 4;
+    while ((size_t(1) << bits) < entries.size() * 2) {
+        ++bits;
+    }
+
+    slots_.assign(size_t(1) << bits, Slot{0, kNotFound});
+    mask_ = (uint32_t(1) << bits) - 1;
+    shift_ = 32 - bits;
+    size_ = 0;
+    overlay_.clear();
+
+    for (const auto& [key, id] : entries) {
+        if (key == 0) continue;
+        uint32_t i = slot_for(key);
+        while (slots_[i].key != 0 && slots_[i].key != key) {
+            i = (i + 1) & mask_;
+        }
+        if (slots_[i].key == 0) ++size_;
+        slots_[i] = Slot{key, id};
+    }
+}
+
+void CodeIndex::assign(uint32_t key, int id) {
+    if (key == 0) return;
+    if (find(key) == kNotFound) ++size_;
+    overlay_[key] = id;
+
+    // Fold the overlay back in before lookups start paying for it
+    if (overlay_.size() > std::max<size_t>(64, slots_.size() / 8)) {
+        merge_overlay();
+    }
+}
+
+void CodeIndex::erase(uint32_t key) {
+    if (key == 0 || find(key) == kNotFound) return;
+    --size_;
+    if (find_base(key) != kNotFound) {
+        overlay_[key] = kNotFound;
+    } else {
+        overlay_.erase(key);
+    }
+}
+
+std::vector<std::pair<uint32_t, int>> CodeIndex::entries() const {
+    std::vector<std::pair<uint32_t, int>> entries;
+    entries.reserve(size_);
+    for (const auto& slot : slots_) {
+        if (slot.key == 0 || overlay_.count(slot.key)) continue;
+        entries.emplace_back(slot.key, slot.id);
+    }
+    for (const auto& [key, id] : overlay_) {
+        if (id != kNotFound) entries.emplace_back(key, id);
+    }
+    return entries;
+}
+
+void CodeIndex::merge_overlay() {
+    build(entries());
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Pack a 1-4 character ASCII code (IATA/ICAO) into a uint32_t, upper-cased.
+// Bytes are case-folded together in a register rather than one at a time.
+// Returns 0, which is never a valid key, for empty, over-long or non-ASCII
+// input.
+inline uint32_t pack_code(std::string_view code) {
+    if (code.empty() || code.size() > 4) return 0;
+
+    uint32_t v = 0;
+    std::memcpy(&v, code.data(), code.size());
+    if (v & 0x80808080u) return 0;
+
+    // Every byte is < 0x80, so these per-byte additions cannot carry over:
+    // the high bit of each byte ends up set iff byte >= 'a' / byte > 'z'
+    uint32_t at_least_a = (v + 0x1f1f1f1fu) & 0x80808080u;
+    uint32_t above_z = (v + 0x05050505u) & 0x80808080u;
+    return v ^ ((at_least_a & ~above_z) >> 2);
+}
+
+// Code -> entity id index. Built once as a flat open-addressing table at
+// load time; later inserts and deletes go to a small overlay that is merged
+// back into the table once it grows past a fraction of the base size.
+class CodeIndex {
+public:
+    static constexpr int kNotFound = -1;
+
+    // Replace the contents; when a key repeats, the last entry wins
+    void build(const std::vector<std::pair<uint32_t, int>>& entries);
+
+    int find(uint32_t key) const {
+        if (key == 0) return kNotFound;
+        if (!overlay_.empty()) {
+            auto it = overlay_.find(key);
+            if (it != overlay_.end()) return it->second;
+        }
+        return find_base(key);
+    }
+
+    int find(std::string_view code) const { return find(pack_code(code)); }
+
+    void assign(uint32_t key, int id);
+    void erase(uint32_t key);
+
+    // Every (key, id) currently mapped, in no particular order
+    std::vector<std::pair<uint32_t, int>> entries() const;
+
+    size_t size() const { return size_; }
+
+private:
+    struct Slot {
+        uint32_t key;  // 0 = empty
+        int id;
+    };
+
+    uint32_t slot_for(uint32_t key) const {
+        // Fibonacci hashing; the high bits of the product are the best mixed
+        return static_cast<uint32_t>((key * 0x9E3779B1u) >> shift_);
+    }
+
+    int find_base(uint32_t key) const {
+        if (slots_.empty()) return kNotFound;
+        for (uint32_t i = slot_for(key);; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return slots_[i].id;
+            if (slots_[i].key == 0) return kNotFound;
+        }
+    }
+
+    void merge_overlay();
+
+    std::vector<Slot> slots_;
+    uint32_t mask_ = 0;
+    uint32_t shift_ = 32;
+    size_t size_ = 0;
+
+    // Changes since the last build; kNotFound marks a key erased from the base
+    std::unordered_map<uint32_t, int> overlay_;
+};
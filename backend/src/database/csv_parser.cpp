@@ -1,8 +1,35 @@
 #include "csv_parser.hpp"
+#include "../utils/csv.hpp"
 #include "../utils/string_utils.hpp"
 #include <fstream>
 #include <iostream>
 
+namespace {
+
+// Fields of the next non-empty record, joining lines while a quoted field
+// spans them; `line_num` ends on the record's last line
+bool read_record(std::istream& file, std::vector<std::string>& fields, int& line_num) {
+    std::string line;
+    while (std::getline(file, line)) {
+        line_num++;
+        if (line.empty()) continue;
+
+        std::string record = std::move(line);
+        while (!utils::csv_split(record, fields)) {
+            // Quote left open at end of file: the short record is reported
+            // as malformed by the caller
+            if (!std::getline(file, line)) return true;
+            line_num++;
+            record += '\n';
+            record += line;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
 std::vector<Airport> CSVParser::parse_airports(const std::string& filepath) {
     std::vector<Airport> airports;
     std::ifstream file(filepath);
@@ -12,13 +39,9 @@ std::vector<Airport> CSVParser::parse_airports(const std::string& filepath) {
         return airports;
     }
 
-    std::string line;
+    std::vector<std::string> tokens;
     int line_num = 0;
-    while (std::getline(file, line)) {
-        line_num++;
-        if (line.empty()) continue;
-
-        auto tokens = utils::split(line, ',');
+    while (read_record(file, tokens, line_num)) {
         if (tokens.size() < 14) {
             std::cerr << "Warning: Skipping malformed airport line " << line_num << std::endl;
             continue;
@@ -26,19 +49,19 @@ std::vector<Airport> CSVParser::parse_airports(const std::string& filepath) {
 
         Airport airport;
         airport.id = utils::safe_stoi(tokens[0]);
-        airport.name = utils::trim(tokens[1]);
-        airport.city = utils::trim(tokens[2]);
-        airport.country = utils::trim(tokens[3]);
-        airport.iata = utils::trim(tokens[4]);
-        airport.icao = utils::trim(tokens[5]);
+        airport.name = tokens[1];
+        airport.city = tokens[2];
+        airport.country = tokens[3];
+        airport.iata = tokens[4];
+        airport.icao = tokens[5];
         airport.latitude = utils::safe_stod(tokens[6]);
         airport.longitude = utils::safe_stod(tokens[7]);
         airport.altitude = utils::safe_stoi(tokens[8]);
         airport.timezone = utils::safe_stod(tokens[9]);
-        airport.dst = utils::trim(tokens[10]);
-        airport.tz_database = utils::trim(tokens[11]);
-        airport.type = utils::trim(tokens[12]);
-        airport.source = utils::trim(tokens[13]);
+        airport.dst = tokens[10];
+        airport.tz_database = tokens[11];
+        airport.type = tokens[12];
+        airport.source = tokens[13];
 
         airports.push_back(airport);
     }
@@ -57,13 +80,9 @@ std::vector<Airline> CSVParser::parse_airlines(const std::string& filepath) {
         return airlines;
     }
 
-    std::string line;
+    std::vector<std::string> tokens;
     int line_num = 0;
-    while (std::getline(file, line)) {
-        line_num++;
-        if (line.empty()) continue;
-
-        auto tokens = utils::split(line, ',');
+    while (read_record(file, tokens, line_num)) {
         if (tokens.size() < 8) {
             std::cerr << "Warning: Skipping malformed airline line " << line_num << std::endl;
             continue;
@@ -71,13 +90,13 @@ std::vector<Airline> CSVParser::parse_airlines(const std::string& filepath) {
 
         Airline airline;
         airline.id = utils::safe_stoi(tokens[0]);
-        airline.name = utils::trim(tokens[1]);
-        airline.alias = utils::trim(tokens[2]);
-        airline.iata = utils::trim(tokens[3]);
-        airline.icao = utils::trim(tokens[4]);
-        airline.callsign = utils::trim(tokens[5]);
-        airline.country = utils::trim(tokens[6]);
-        airline.active = utils::trim(tokens[7]);
+        airline.name = tokens[1];
+        airline.alias = tokens[2];
+        airline.iata = tokens[3];
+        airline.icao = tokens[4];
+        airline.callsign = tokens[5];
+        airline.country = tokens[6];
+        airline.active = tokens[7];
 
         airlines.push_back(airline);
     }
@@ -96,28 +115,24 @@ std::vector<Route> CSVParser::parse_routes(const std::string& filepath) {
         return routes;
     }
 
-    std::string line;
+    std::vector<std::string> tokens;
     int line_num = 0;
-    while (std::getline(file, line)) {
-        line_num++;
-        if (line.empty()) continue;
-
-        auto tokens = utils::split(line, ',');
+    while (read_record(file, tokens, line_num)) {
         if (tokens.size() < 9) {
             std::cerr << "Warning: Skipping malformed route line " << line_num << std::endl;
             continue;
         }
 
         Route route;
-        route.airline_iata = utils::trim(tokens[0]);
+        route.airline_iata = tokens[0];
         route.airline_id = utils::safe_stoi(tokens[1]);
-        route.source_airport_iata = utils::trim(tokens[2]);
+        route.source_airport_iata = tokens[2];
         route.source_airport_id = utils::safe_stoi(tokens[3]);
-        route.dest_airport_iata = utils::trim(tokens[4]);
+        route.dest_airport_iata = tokens[4];
         route.dest_airport_id = utils::safe_stoi(tokens[5]);
-        route.codeshare = utils::trim(tokens[6]);
+        route.codeshare = tokens[6];
         route.stops = utils::safe_stoi(tokens[7]);
-        route.equipment = tokens.size() > 8 ? utils::trim(tokens[8]) : "";
+        route.equipment = tokens.size() > 8 ? tokens[8] : "";
 
         routes.push_back(route);
     }
@@ -1,46 +1,149 @@
 #include "data_store.hpp"
 #include "csv_parser.hpp"
 #include "../utils/string_utils.hpp"
+#include "../metrics/metrics.hpp"
+#include "../metrics/slow_query_log.hpp"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
 
+namespace {
+
+metrics::Histogram op_histogram(const std::string& op) {
+    return metrics::histogram("flight_datastore_op_duration_seconds", "op=\"" + op + "\"",
+                              "DataStore operation latency", 1e-6);
+}
+
+// Index key for an IATA/ICAO field; 0 (never indexed) for "\N" and empty codes
+uint32_t code_key(const std::string& code) {
+    return utils::is_null(code) ? 0 : pack_code(code);
+}
+
+using RowIndex = std::unordered_map<int, std::vector<size_t>>;
+
+// Drop `row` from an airport's or airline's row list, forgetting empty lists
+void unlink_row(RowIndex& index, int id, size_t row) {
+    auto it = index.find(id);
+    if (it == index.end()) return;
+    auto& rows = it->second;
+    rows.erase(std::find(rows.begin(), rows.end(), row));
+    if (rows.empty()) index.erase(it);
+}
+
+void relabel_row(RowIndex& index, int id, size_t from, size_t to) {
+    auto& rows = index[id];
+    *std::find(rows.begin(), rows.end(), from) = to;
+}
+
+} // namespace
+
 DataStore::DataStore() {}
 
 bool DataStore::load_data(const std::string& airports_path, 
                           const std::string& airlines_path, 
                           const std::string& routes_path) {
-    // Load airports
-    auto airports = CSVParser::parse_airports(airports_path);
-    for (const auto& airport : airports) {
-        airports_by_id_[airport.id] = airport;
-        if (!airport.iata.empty() && !utils::is_null(airport.iata)) {
-            airport_iata_to_id_[utils::to_upper(airport.iata)] = airport.id;
-        }
-    }
+    static const auto op_time = op_histogram("load_data");
+    metrics::ScopedTimer timer(op_time);
 
-    // Load airlines
+    auto airports = CSVParser::parse_airports(airports_path);
     auto airlines = CSVParser::parse_airlines(airlines_path);
-    for (const auto& airline : airlines) {
-        airlines_by_id_[airline.id] = airline;
-        if (!airline.iata.empty() && !utils::is_null(airline.iata)) {
-            airline_iata_to_id_[utils::to_upper(airline.iata)] = airline.id;
-        }
-    }
+    auto routes = CSVParser::parse_routes(routes_path);
 
-    // Load routes
-    routes_ = CSVParser::parse_routes(routes_path);
-    rebuild_route_indexes();
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    replace_tables(std::move(airports), std::move(airlines), std::move(routes), nullptr);
 
     std::cout << "Data loading complete: " 
               << airports_by_id_.size() << " airports, "
               << airlines_by_id_.size() << " airlines, "
               << routes_.size() << " routes" << std::endl;
+    return !airports_by_id_.empty() && !airlines_by_id_.empty();
+}
 
+StoreSnapshot DataStore::snapshot() const {
+    static const auto op_time = op_histogram("snapshot");
+    metrics::ScopedTimer timer(op_time);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    // Mutations append to the change log under the exclusive lock, so the
+    // sequence number read here matches the tables exactly
+    StoreSnapshot snapshot;
+    snapshot.seq = change_log_.current_seq();
+    snapshot.generation = change_log_.generation();
+    snapshot.airports.reserve(airports_by_id_.size());
+    for (const auto& [id, airport] : airports_by_id_) snapshot.airports.push_back(airport);
+    snapshot.airlines.reserve(airlines_by_id_.size());
+    for (const auto& [id, airline] : airlines_by_id_) snapshot.airlines.push_back(airline);
+    snapshot.routes = routes_;
+    snapshot.codes.airport_iata = airport_iata_index_.entries();
+    snapshot.codes.airport_icao = airport_icao_index_.entries();
+    snapshot.codes.airline_iata = airline_iata_index_.entries();
+    snapshot.codes.airline_icao = airline_icao_index_.entries();
+    return snapshot;
+}
+
+bool DataStore::load_snapshot(StoreSnapshot snapshot) {
+    static const auto op_time = op_histogram("load_snapshot");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    replace_tables(std::move(snapshot.airports), std::move(snapshot.airlines),
+                   std::move(snapshot.routes), &snapshot.codes);
+    change_log_.reset(snapshot.seq);
+    // Versions numbered before the reset may be reused for other data
+    version_pins_.reset(change_log_.generation());
     return !airports_by_id_.empty() && !airlines_by_id_.empty();
 }
 
+void DataStore::replace_tables(std::vector<Airport> airports, std::vector<Airline> airlines,
+                               std::vector<Route> routes, const CodeMaps* codes) {
+    CodeMaps from_rows;
+    if (!codes) {
+        for (const auto& airport : airports) {
+            from_rows.airport_iata.emplace_back(code_key(airport.iata), airport.id);
+            from_rows.airport_icao.emplace_back(code_key(airport.icao), airport.id);
+        }
+        for (const auto& airline : airlines) {
+            from_rows.airline_iata.emplace_back(code_key(airline.iata), airline.id);
+            from_rows.airline_icao.emplace_back(code_key(airline.icao), airline.id);
+        }
+        codes = &from_rows;
+    }
+    airport_iata_index_.build(codes->airport_iata);
+    airport_icao_index_.build(codes->airport_icao);
+    airline_iata_index_.build(codes->airline_iata);
+    airline_icao_index_.build(codes->airline_icao);
+
+    // Load airports
+    airports_by_id_.clear();
+    for (auto& airport : airports) {
+        airports_by_id_[airport.id] = std::move(airport);
+    }
+    hot_.build_airports(airports_by_id_);
+
+    // Load airlines
+    airlines_by_id_.clear();
+    for (auto& airline : airlines) {
+        airlines_by_id_[airline.id] = std::move(airline);
+    }
+
+    // Load routes
+    routes_ = std::move(routes);
+    rebuild_route_indexes();
+    analytics_.build(routes_, airports_by_id_);
+
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(routes_.size());
+    for (const auto& route : routes_) {
+        if (route_in_graph(route)) edges.emplace_back(route.source_airport_id, route.dest_airport_id);
+    }
+    reachability_.build(edges);
+    one_hop_cache_.clear();
+}
+
 void DataStore::rebuild_route_indexes() {
+    static const auto op_time = op_histogram("rebuild_route_indexes");
+    metrics::ScopedTimer timer(op_time);
+
     routes_from_airport_.clear();
     routes_to_airport_.clear();
     routes_by_airline_.clear();
@@ -51,165 +154,414 @@ void DataStore::rebuild_route_indexes() {
         routes_to_airport_[route.dest_airport_id].push_back(i);
         routes_by_airline_[route.airline_id].push_back(i);
     }
+    route_columns_.build(routes_);
+    hot_.build_routes(routes_);
+}
+
+std::optional<size_t> DataStore::find_route_row(int airline_id, int source_airport_id,
+                                               int dest_airport_id) const {
+    auto it = routes_from_airport_.find(source_airport_id);
+    if (it == routes_from_airport_.end()) return std::nullopt;
+    for (size_t row : it->second) {
+        const RouteHot& route = hot_.route(row);
+        if (route.airline_id == airline_id && route.dest_airport_id == dest_airport_id) return row;
+    }
+    return std::nullopt;
+}
+
+// O(degree) removal of one route: the last row moves into its slot, so
+// only the rows lists of the two routes involved change
+void DataStore::erase_route_row(size_t row) {
+    const Route& removed = routes_[row];
+    unlink_row(routes_from_airport_, removed.source_airport_id, row);
+    unlink_row(routes_to_airport_, removed.dest_airport_id, row);
+    unlink_row(routes_by_airline_, removed.airline_id, row);
+
+    size_t last = routes_.size() - 1;
+    const Route& moved = routes_[last];
+    route_columns_.swap_remove(row, removed, moved);
+    hot_.swap_remove_route(row);
+    if (row != last) {
+        relabel_row(routes_from_airport_, moved.source_airport_id, last, row);
+        relabel_row(routes_to_airport_, moved.dest_airport_id, last, row);
+        relabel_row(routes_by_airline_, moved.airline_id, last, row);
+        // Swapped rather than move-assigned so the removed route's string
+        // buffers are freed with it, not kept by the moved row
+        std::swap(routes_[row], routes_[last]);
+    }
+    routes_.pop_back();
+}
+
+void DataStore::record_route_removals(const std::vector<Route>& removed) {
+    for (const auto& route : removed) {
+        change_log_.append(ChangeOp::Delete, ChangeEntity::Route, route.get_key(), "", true);
+    }
+}
+
+// Routes referencing unknown airports (\N ids in the source data) can never
+// be a leg of a search result, so they stay out of the reachability graph
+bool DataStore::route_in_graph(const Route& route) const {
+    return airports_by_id_.count(route.source_airport_id) &&
+           airports_by_id_.count(route.dest_airport_id);
+}
+
+void DataStore::remove_from_reachability(const std::vector<Route>& removed) {
+    std::vector<std::pair<int, int>> edges;
+    for (const auto& route : removed) {
+        if (route_in_graph(route)) edges.emplace_back(route.source_airport_id, route.dest_airport_id);
+    }
+    reachability_.remove_edges(edges);
+}
+
+void DataStore::invalidate_one_hop(const std::vector<Route>& changed) {
+    for (const auto& route : changed) {
+        one_hop_cache_.invalidate_route(route.source_airport_id, route.dest_airport_id);
+    }
+}
+
+std::optional<DataStore::ReadView> DataStore::read_at(std::optional<uint64_t> version) const {
+    ReadView live = read();
+    if (!version || live.version() == *version) return live;
+
+    auto snapshot = version_pins_.find(*version);
+    if (!snapshot) return std::nullopt;
+    ReadView view = snapshot->read();
+    view.snapshot_ = std::move(snapshot);
+    // The copy is from the live store's current generation: load_snapshot()
+    // drops older ones under the exclusive lock `live` keeps out
+    view.generation_ = live.generation();
+    return view;
+}
+
+std::optional<VersionPins::Pin> DataStore::pin(std::chrono::seconds ttl) {
+    static const auto op_time = op_histogram("pin");
+    metrics::ScopedTimer timer(op_time);
+
+    uint64_t generation, version;
+    auto snapshot = current_copy(generation, version);
+    // Refused if a snapshot load reset the versions meanwhile
+    return version_pins_.add(generation, version, std::move(snapshot), ttl);
+}
+
+DataStore::ReadView DataStore::read_frozen() const {
+    uint64_t generation, version;
+    auto copy = current_copy(generation, version);
+    ReadView view = copy->read();
+    view.snapshot_ = std::move(copy);
+    view.generation_ = generation;
+    return view;
+}
+
+VersionPins::Snapshot DataStore::current_copy(uint64_t& generation, uint64_t& version) const {
+    // Reuse the copy of the current version if there is one; otherwise
+    // build one from a consistent snapshot, outside any of our locks
+    {
+        ReadView live = read();
+        generation = live.generation();
+        version = live.version();
+        if (auto held = version_pins_.find(version)) return held;
+    }
+    StoreSnapshot tables = snapshot();
+    generation = tables.generation;
+    version = tables.seq;
+    auto copy = std::make_shared<DataStore>();
+    copy->load_snapshot(std::move(tables));
+    copy->publish_centrality(get_centrality());
+    return version_pins_.share(generation, version, std::move(copy));
+}
+
+DataStore::ReadView DataStore::read() const {
+    return ReadView(*this);
+}
+
+size_t DataStore::get_airport_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return airports_by_id_.size();
+}
+
+size_t DataStore::get_airline_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return airlines_by_id_.size();
+}
+
+HotRecords::Footprint DataStore::get_hot_footprint() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return hot_.footprint();
+}
+
+size_t DataStore::get_route_count() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return routes_.size();
+}
+
+// Lookup helpers shared by ReadView and the mutation paths
+const Airport* DataStore::find_airport_by_id(int id) const {
+    auto it = airports_by_id_.find(id);
+    return it != airports_by_id_.end() ? &it->second : nullptr;
+}
+
+const Airline* DataStore::find_airline_by_id(int id) const {
+    auto it = airlines_by_id_.find(id);
+    return it != airlines_by_id_.end() ? &it->second : nullptr;
+}
+
+const Airport* DataStore::find_airport_by_code(const CodeIndex& index, std::string_view code) const {
+    int id = index.find(code);
+    return id != CodeIndex::kNotFound ? find_airport_by_id(id) : nullptr;
+}
+
+const Airline* DataStore::find_airline_by_code(const CodeIndex& index, std::string_view code) const {
+    int id = index.find(code);
+    return id != CodeIndex::kNotFound ? find_airline_by_id(id) : nullptr;
 }
 
 // 1. Individual Entity Retrieval
 std::optional<Airline> DataStore::get_airline_by_iata(const std::string& iata) const {
-    auto upper_iata = utils::to_upper(iata);
-    auto it = airline_iata_to_id_.find(upper_iata);
-    if (it != airline_iata_to_id_.end()) {
-        return get_airline_by_id(it->second);
+    auto view = read();
+    if (auto airline = view.airline_by_iata(iata)) {
+        return *airline;
     }
     return std::nullopt;
 }
 
 std::optional<Airport> DataStore::get_airport_by_iata(const std::string& iata) const {
-    auto upper_iata = utils::to_upper(iata);
-    auto it = airport_iata_to_id_.find(upper_iata);
-    if (it != airport_iata_to_id_.end()) {
-        return get_airport_by_id(it->second);
+    auto view = read();
+    if (auto airport = view.airport_by_iata(iata)) {
+        return *airport;
+    }
+    return std::nullopt;
+}
+
+std::optional<Airline> DataStore::get_airline_by_icao(const std::string& icao) const {
+    auto view = read();
+    if (auto airline = view.airline_by_icao(icao)) {
+        return *airline;
+    }
+    return std::nullopt;
+}
+
+std::optional<Airport> DataStore::get_airport_by_icao(const std::string& icao) const {
+    auto view = read();
+    if (auto airport = view.airport_by_icao(icao)) {
+        return *airport;
     }
     return std::nullopt;
 }
 
 std::optional<Airline> DataStore::get_airline_by_id(int id) const {
-    auto it = airlines_by_id_.find(id);
-    if (it != airlines_by_id_.end()) {
-        return it->second;
+    auto view = read();
+    if (auto airline = view.airline_by_id(id)) {
+        return *airline;
     }
     return std::nullopt;
 }
 
 std::optional<Airport> DataStore::get_airport_by_id(int id) const {
-    auto it = airports_by_id_.find(id);
-    if (it != airports_by_id_.end()) {
-        return it->second;
+    auto view = read();
+    if (auto airport = view.airport_by_id(id)) {
+        return *airport;
     }
     return std::nullopt;
 }
 
 // 2.1a Get airports reached by airline, ordered by route count
-std::vector<AirportRouteCount> DataStore::get_airports_by_airline_routes(
-    const std::string& airline_iata) const {
-    
-    auto airline_opt = get_airline_by_iata(airline_iata);
-    if (!airline_opt) {
-        return {};
-    }
+std::vector<AirportRouteRef> DataStore::ReadView::airports_by_airline_routes(
+    const Airline& airline) const {
+    static const auto op_time = op_histogram("get_airports_by_airline_routes");
+    metrics::ScopedTimer timer(op_time);
 
-    int airline_id = airline_opt->id;
-    
     // Count routes per airport for this airline
     std::unordered_map<int, int> airport_route_counts;
-    
-    auto it = routes_by_airline_.find(airline_id);
-    if (it != routes_by_airline_.end()) {
+
+    auto it = store_->routes_by_airline_.find(airline.id);
+    if (it != store_->routes_by_airline_.end()) {
         for (size_t route_idx : it->second) {
-            const auto& route = routes_[route_idx];
+            const RouteHot& route = store_->hot_.route(route_idx);
             airport_route_counts[route.source_airport_id]++;
             airport_route_counts[route.dest_airport_id]++;
         }
     }
 
     // Build result vector
-    std::vector<AirportRouteCount> results;
+    std::vector<AirportRouteRef> results;
+    results.reserve(airport_route_counts.size());
     for (const auto& [airport_id, count] : airport_route_counts) {
-        auto airport_opt = get_airport_by_id(airport_id);
-        if (airport_opt) {
-            results.push_back({*airport_opt, count});
+        if (auto airport = store_->find_airport_by_id(airport_id)) {
+            results.push_back({airport, count});
         }
     }
 
     // Sort by route count (descending)
-    std::sort(results.begin(), results.end(), 
-              [](const AirportRouteCount& a, const AirportRouteCount& b) {
+    std::sort(results.begin(), results.end(),
+              [](const AirportRouteRef& a, const AirportRouteRef& b) {
                   return a.route_count > b.route_count;
               });
 
     return results;
 }
 
-// 2.1b Get airlines serving airport, ordered by route count
-std::vector<AirlineRouteCount> DataStore::get_airlines_by_airport_routes(
-    const std::string& airport_iata) const {
-    
-    auto airport_opt = get_airport_by_iata(airport_iata);
-    if (!airport_opt) {
+std::vector<AirportRouteCount> DataStore::get_airports_by_airline_routes(
+    const std::string& airline_iata) const {
+    auto view = read();
+    auto airline = view.airline_by_iata(airline_iata);
+    if (!airline) {
         return {};
     }
 
-    int airport_id = airport_opt->id;
-    
+    std::vector<AirportRouteCount> results;
+    for (const auto& ref : view.airports_by_airline_routes(*airline)) {
+        results.push_back({*ref.airport, ref.route_count});
+    }
+    return results;
+}
+
+// 2.1b Get airlines serving airport, ordered by route count
+std::vector<AirlineRouteRef> DataStore::ReadView::airlines_by_airport_routes(
+    const Airport& airport) const {
+    static const auto op_time = op_histogram("get_airlines_by_airport_routes");
+    metrics::ScopedTimer timer(op_time);
+
     // Count routes per airline for this airport
     std::unordered_map<int, int> airline_route_counts;
-    
+
     // Check routes from this airport
-    auto from_it = routes_from_airport_.find(airport_id);
-    if (from_it != routes_from_airport_.end()) {
+    auto from_it = store_->routes_from_airport_.find(airport.id);
+    if (from_it != store_->routes_from_airport_.end()) {
         for (size_t route_idx : from_it->second) {
-            airline_route_counts[routes_[route_idx].airline_id]++;
+            airline_route_counts[store_->hot_.route(route_idx).airline_id]++;
         }
     }
 
     // Check routes to this airport
-    auto to_it = routes_to_airport_.find(airport_id);
-    if (to_it != routes_to_airport_.end()) {
+    auto to_it = store_->routes_to_airport_.find(airport.id);
+    if (to_it != store_->routes_to_airport_.end()) {
         for (size_t route_idx : to_it->second) {
-            airline_route_counts[routes_[route_idx].airline_id]++;
+            airline_route_counts[store_->hot_.route(route_idx).airline_id]++;
         }
     }
 
     // Build result vector
-    std::vector<AirlineRouteCount> results;
+    std::vector<AirlineRouteRef> results;
+    results.reserve(airline_route_counts.size());
     for (const auto& [airline_id, count] : airline_route_counts) {
-        auto airline_opt = get_airline_by_id(airline_id);
-        if (airline_opt) {
-            results.push_back({*airline_opt, count});
+        if (auto airline = store_->find_airline_by_id(airline_id)) {
+            results.push_back({airline, count});
         }
     }
 
     // Sort by route count (descending)
-    std::sort(results.begin(), results.end(), 
-              [](const AirlineRouteCount& a, const AirlineRouteCount& b) {
+    std::sort(results.begin(), results.end(),
+              [](const AirlineRouteRef& a, const AirlineRouteRef& b) {
                   return a.route_count > b.route_count;
               });
 
     return results;
 }
 
+std::vector<AirlineRouteCount> DataStore::get_airlines_by_airport_routes(
+    const std::string& airport_iata) const {
+    auto view = read();
+    auto airport = view.airport_by_iata(airport_iata);
+    if (!airport) {
+        return {};
+    }
+
+    std::vector<AirlineRouteCount> results;
+    for (const auto& ref : view.airlines_by_airport_routes(*airport)) {
+        results.push_back({*ref.airline, ref.route_count});
+    }
+    return results;
+}
+
 // 2.2 Get all airlines/airports sorted by IATA
-std::vector<Airline> DataStore::get_all_airlines_sorted_by_iata() const {
-    std::vector<Airline> airlines;
-    for (const auto& [id, airline] : airlines_by_id_) {
+std::vector<const Airline*> DataStore::ReadView::airlines_sorted_by_iata() const {
+    static const auto op_time = op_histogram("get_all_airlines_sorted_by_iata");
+    metrics::ScopedTimer timer(op_time);
+
+    std::vector<const Airline*> airlines;
+    airlines.reserve(store_->airline_iata_index_.size());
+    for (const auto& [id, airline] : store_->airlines_by_id_) {
         if (!airline.iata.empty() && !utils::is_null(airline.iata)) {
-            airlines.push_back(airline);
+            airlines.push_back(&airline);
         }
     }
-    
-    std::sort(airlines.begin(), airlines.end(), 
-              [](const Airline& a, const Airline& b) {
-                  return a.iata < b.iata;
+
+    std::sort(airlines.begin(), airlines.end(),
+              [](const Airline* a, const Airline* b) {
+                  return a->iata < b->iata;
               });
-    
+
     return airlines;
 }
 
-std::vector<Airport> DataStore::get_all_airports_sorted_by_iata() const {
-    std::vector<Airport> airports;
-    for (const auto& [id, airport] : airports_by_id_) {
+std::vector<const Airport*> DataStore::ReadView::airports_sorted_by_iata() const {
+    static const auto op_time = op_histogram("get_all_airports_sorted_by_iata");
+    metrics::ScopedTimer timer(op_time);
+
+    std::vector<const Airport*> airports;
+    airports.reserve(store_->airport_iata_index_.size());
+    for (const auto& [id, airport] : store_->airports_by_id_) {
         if (!airport.iata.empty() && !utils::is_null(airport.iata)) {
-            airports.push_back(airport);
+            airports.push_back(&airport);
         }
     }
-    
-    std::sort(airports.begin(), airports.end(), 
-              [](const Airport& a, const Airport& b) {
-                  return a.iata < b.iata;
+
+    std::sort(airports.begin(), airports.end(),
+              [](const Airport* a, const Airport* b) {
+                  return a->iata < b->iata;
               });
-    
+
+    return airports;
+}
+
+std::vector<const Airline*> DataStore::ReadView::airlines_by_id() const {
+    std::vector<const Airline*> airlines;
+    airlines.reserve(store_->airlines_by_id_.size());
+    for (const auto& [id, airline] : store_->airlines_by_id_) airlines.push_back(&airline);
+    std::sort(airlines.begin(), airlines.end(),
+              [](const Airline* a, const Airline* b) { return a->id < b->id; });
+    return airlines;
+}
+
+std::vector<const Airport*> DataStore::ReadView::airports_by_id() const {
+    std::vector<const Airport*> airports;
+    airports.reserve(store_->airports_by_id_.size());
+    for (const auto& [id, airport] : store_->airports_by_id_) airports.push_back(&airport);
+    std::sort(airports.begin(), airports.end(),
+              [](const Airport* a, const Airport* b) { return a->id < b->id; });
+    return airports;
+}
+
+std::vector<Airline> DataStore::get_all_airlines_sorted_by_iata() const {
+    auto view = read();
+    std::vector<Airline> airlines;
+    for (auto airline : view.airlines_sorted_by_iata()) {
+        airlines.push_back(*airline);
+    }
+    return airlines;
+}
+
+std::vector<Airport> DataStore::get_all_airports_sorted_by_iata() const {
+    auto view = read();
+    std::vector<Airport> airports;
+    for (auto airport : view.airports_sorted_by_iata()) {
+        airports.push_back(*airport);
+    }
     return airports;
 }
 
+// Route filter scan over the columnar table
+std::vector<const Route*> DataStore::ReadView::filter_routes(const RouteFilter& filter) const {
+    static const auto op_time = op_histogram("filter_routes");
+    metrics::ScopedTimer timer(op_time);
+
+    std::vector<const Route*> routes;
+    for (size_t row : store_->route_columns_.filter(filter)) {
+        routes.push_back(&store_->routes_[row]);
+    }
+    return routes;
+}
+
 // 2.3 Get system ID
 std::pair<int, std::string> DataStore::get_system_id() const {
     return {12345, "Flight Data System v1.0"};
@@ -217,30 +569,69 @@ std::pair<int, std::string> DataStore::get_system_id() const {
 
 // 3. Insert operations
 bool DataStore::insert_airport(const Airport& airport) {
+    static const auto op_time = op_histogram("insert_airport");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     if (airports_by_id_.find(airport.id) != airports_by_id_.end()) {
         return false; // ID already exists
     }
     
     airports_by_id_[airport.id] = airport;
-    if (!airport.iata.empty() && !utils::is_null(airport.iata)) {
-        airport_iata_to_id_[utils::to_upper(airport.iata)] = airport.id;
+    airport_iata_index_.assign(code_key(airport.iata), airport.id);
+    airport_icao_index_.assign(code_key(airport.icao), airport.id);
+    hot_.put_airport(airport);
+
+    // Routes loaded before the airport existed now join the graph, and
+    // their country-matrix counts move from the unknown country to its own
+    std::vector<const Route*> touching;
+    for (const auto* index : {&routes_from_airport_, &routes_to_airport_}) {
+        auto rows = index->find(airport.id);
+        if (rows == index->end()) continue;
+        for (size_t row : rows->second) {
+            const Route& route = routes_[row];
+            bool counted = index == &routes_to_airport_ && route.source_airport_id == airport.id;
+            if (counted) continue;
+            touching.push_back(&route);
+            if (route_in_graph(route)) {
+                reachability_.add_edge(route.source_airport_id, route.dest_airport_id);
+                one_hop_cache_.invalidate_route(route.source_airport_id, route.dest_airport_id);
+            }
+        }
     }
+    analytics_.change_airport_country(airport.id, "", airport.country, touching, airports_by_id_);
+    change_log_.append(ChangeOp::Insert, ChangeEntity::Airport,
+                       std::to_string(airport.id), airport.to_json().dump());
     return true;
 }
 
 bool DataStore::insert_airline(const Airline& airline) {
+    static const auto op_time = op_histogram("insert_airline");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     if (airlines_by_id_.find(airline.id) != airlines_by_id_.end()) {
         return false; // ID already exists
     }
     
     airlines_by_id_[airline.id] = airline;
-    if (!airline.iata.empty() && !utils::is_null(airline.iata)) {
-        airline_iata_to_id_[utils::to_upper(airline.iata)] = airline.id;
-    }
+    airline_iata_index_.assign(code_key(airline.iata), airline.id);
+    airline_icao_index_.assign(code_key(airline.icao), airline.id);
+    change_log_.append(ChangeOp::Insert, ChangeEntity::Airline,
+                       std::to_string(airline.id), airline.to_json().dump());
     return true;
 }
 
 bool DataStore::insert_route(const Route& route) {
+    static const auto op_time = op_histogram("insert_route");
+    metrics::ScopedTimer timer(op_time);
+
+    // Serialized before taking the lock; it only reads the caller's copy
+    std::string key = route.get_key();
+    std::string payload = route.to_json().dump();
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     // Check if airline and airports exist
     if (airlines_by_id_.find(route.airline_id) == airlines_by_id_.end() ||
         airports_by_id_.find(route.source_airport_id) == airports_by_id_.end() ||
@@ -248,102 +639,138 @@ bool DataStore::insert_route(const Route& route) {
         return false;
     }
 
-    // Check for duplicate route
-    std::string key = route.get_key();
-    for (const auto& existing_route : routes_) {
-        if (existing_route.get_key() == key) {
-            return false; // Route already exists
-        }
+    // Duplicate check over the source airport's routes only
+    if (find_route_row(route.airline_id, route.source_airport_id, route.dest_airport_id)) {
+        return false; // Route already exists
     }
 
+    // Appending leaves existing row numbers alone, so the indexes can be
+    // extended in place instead of rebuilt
+    size_t row = routes_.size();
     routes_.push_back(route);
-    rebuild_route_indexes();
+    routes_from_airport_[route.source_airport_id].push_back(row);
+    routes_to_airport_[route.dest_airport_id].push_back(row);
+    routes_by_airline_[route.airline_id].push_back(row);
+    route_columns_.append(route);
+    hot_.append_route(route);
+    analytics_.add_route(route, airports_by_id_);
+    reachability_.add_edge(route.source_airport_id, route.dest_airport_id);
+    one_hop_cache_.invalidate_route(route.source_airport_id, route.dest_airport_id);
+    change_log_.append(ChangeOp::Insert, ChangeEntity::Route, key, std::move(payload));
     return true;
 }
 
 // 3. Remove operations
 bool DataStore::remove_airport(int airport_id) {
+    static const auto op_time = op_histogram("remove_airport");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     auto it = airports_by_id_.find(airport_id);
     if (it == airports_by_id_.end()) {
         return false;
     }
 
-    // Remove from IATA index
-    const auto& iata = it->second.iata;
-    if (!iata.empty()) {
-        airport_iata_to_id_.erase(utils::to_upper(iata));
+    // Remove from code indexes
+    airport_iata_index_.erase(code_key(it->second.iata));
+    airport_icao_index_.erase(code_key(it->second.icao));
+
+    // Remove all routes involving this airport
+    auto first_removed = std::stable_partition(routes_.begin(), routes_.end(),
+                      [airport_id](const Route& r) {
+                          return r.source_airport_id != airport_id &&
+                                 r.dest_airport_id != airport_id;
+                      });
+    std::vector<Route> removed(first_removed, routes_.end());
+    routes_.erase(first_removed, routes_.end());
+
+    // Analytics still needs the airport's country to retract its routes
+    for (const auto& route : removed) {
+        analytics_.remove_route(route, airports_by_id_);
     }
+    remove_from_reachability(removed);
+    invalidate_one_hop(removed);
+    one_hop_cache_.invalidate_airport(airport_id);
 
     // Remove airport
     airports_by_id_.erase(it);
-
-    // Remove all routes involving this airport
-    routes_.erase(
-        std::remove_if(routes_.begin(), routes_.end(),
-                      [airport_id](const Route& r) {
-                          return r.source_airport_id == airport_id || 
-                                 r.dest_airport_id == airport_id;
-                      }),
-        routes_.end()
-    );
+    hot_.remove_airport(airport_id);
 
     rebuild_route_indexes();
+    record_route_removals(removed);
+    change_log_.append(ChangeOp::Delete, ChangeEntity::Airport, std::to_string(airport_id));
     return true;
 }
 
 bool DataStore::remove_airline(int airline_id) {
+    static const auto op_time = op_histogram("remove_airline");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     auto it = airlines_by_id_.find(airline_id);
     if (it == airlines_by_id_.end()) {
         return false;
     }
 
-    // Remove from IATA index
-    const auto& iata = it->second.iata;
-    if (!iata.empty()) {
-        airline_iata_to_id_.erase(utils::to_upper(iata));
-    }
+    // Remove from code indexes
+    airline_iata_index_.erase(code_key(it->second.iata));
+    airline_icao_index_.erase(code_key(it->second.icao));
 
     // Remove airline
     airlines_by_id_.erase(it);
 
     // Remove all routes for this airline
-    routes_.erase(
-        std::remove_if(routes_.begin(), routes_.end(),
+    auto first_removed = std::stable_partition(routes_.begin(), routes_.end(),
                       [airline_id](const Route& r) {
-                          return r.airline_id == airline_id;
-                      }),
-        routes_.end()
-    );
+                          return r.airline_id != airline_id;
+                      });
+    std::vector<Route> removed(first_removed, routes_.end());
+    routes_.erase(first_removed, routes_.end());
+    for (const auto& route : removed) {
+        analytics_.remove_route(route, airports_by_id_);
+    }
+    remove_from_reachability(removed);
+    invalidate_one_hop(removed);
 
     rebuild_route_indexes();
+    record_route_removals(removed);
+    change_log_.append(ChangeOp::Delete, ChangeEntity::Airline, std::to_string(airline_id));
     return true;
 }
 
 bool DataStore::remove_route(int airline_id, int source_airport_id, int dest_airport_id) {
-    std::string key = std::to_string(airline_id) + "_" + 
-                     std::to_string(source_airport_id) + "_" + 
-                     std::to_string(dest_airport_id);
+    static const auto op_time = op_histogram("remove_route");
+    metrics::ScopedTimer timer(op_time);
 
-    auto it = std::find_if(routes_.begin(), routes_.end(),
-                          [&key](const Route& r) { return r.get_key() == key; });
-
-    if (it == routes_.end()) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto row = find_route_row(airline_id, source_airport_id, dest_airport_id);
+    if (!row) {
         return false;
     }
 
-    routes_.erase(it);
-    rebuild_route_indexes();
+    const Route& route = routes_[*row];
+    std::string key = route.get_key();
+    analytics_.remove_route(route, airports_by_id_);
+    remove_from_reachability({route});
+    invalidate_one_hop({route});
+    erase_route_row(*row);
+    change_log_.append(ChangeOp::Delete, ChangeEntity::Route, key);
     return true;
 }
 
 // 3. Modify operations
 bool DataStore::modify_airport(int airport_id, const crow::json::rvalue& updates) {
+    static const auto op_time = op_histogram("modify_airport");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     auto it = airports_by_id_.find(airport_id);
     if (it == airports_by_id_.end()) {
         return false;
     }
 
     Airport& airport = it->second;
+    const std::string old_country = airport.country;
     
     // Update fields if present
     if (updates.has("name")) airport.name = updates["name"].s();
@@ -353,23 +780,48 @@ bool DataStore::modify_airport(int airport_id, const crow::json::rvalue& updates
     if (updates.has("longitude")) airport.longitude = updates["longitude"].d();
     if (updates.has("altitude")) airport.altitude = updates["altitude"].i();
     if (updates.has("timezone")) airport.timezone = updates["timezone"].d();
+
+    // Country change moves the airport's routes between country-matrix cells
+    if (airport.country != old_country) {
+        std::vector<const Route*> touching;
+        for (const auto* index : {&routes_from_airport_, &routes_to_airport_}) {
+            auto routes = index->find(airport_id);
+            if (routes == index->end()) continue;
+            for (size_t route_idx : routes->second) {
+                const Route& route = routes_[route_idx];
+                // Self-loops are in both indexes; count them once
+                if (index == &routes_to_airport_ && route.source_airport_id == airport_id) continue;
+                touching.push_back(&route);
+            }
+        }
+        analytics_.change_airport_country(airport_id, old_country, airport.country,
+                                          touching, airports_by_id_);
+    }
     
     // IATA change requires index update
     if (updates.has("iata")) {
         std::string old_iata = utils::to_upper(airport.iata);
         std::string new_iata = utils::to_upper(std::string(updates["iata"].s()));
         
-        airport_iata_to_id_.erase(old_iata);
+        airport_iata_index_.erase(code_key(old_iata));
         airport.iata = new_iata;
-        if (!new_iata.empty()) {
-            airport_iata_to_id_[new_iata] = airport_id;
-        }
+        airport_iata_index_.assign(code_key(new_iata), airport_id);
     }
 
+    // Coordinates and codes appear in one-hop results
+    hot_.put_airport(airport);
+    one_hop_cache_.invalidate_airport(airport_id);
+
+    change_log_.append(ChangeOp::Update, ChangeEntity::Airport,
+                       std::to_string(airport_id), airport.to_json().dump());
     return true;
 }
 
 bool DataStore::modify_airline(int airline_id, const crow::json::rvalue& updates) {
+    static const auto op_time = op_histogram("modify_airline");
+    metrics::ScopedTimer timer(op_time);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
     auto it = airlines_by_id_.find(airline_id);
     if (it == airlines_by_id_.end()) {
         return false;
@@ -379,7 +831,6 @@ bool DataStore::modify_airline(int airline_id, const crow::json::rvalue& updates
     
     if (updates.has("name")) airline.name = updates["name"].s();
     if (updates.has("alias")) airline.alias = updates["alias"].s();
-    if (updates.has("icao")) airline.icao = updates["icao"].s();
     if (updates.has("callsign")) airline.callsign = updates["callsign"].s();
     if (updates.has("country")) airline.country = updates["country"].s();
     if (updates.has("active")) airline.active = updates["active"].s();
@@ -389,152 +840,263 @@ bool DataStore::modify_airline(int airline_id, const crow::json::rvalue& updates
         std::string old_iata = utils::to_upper(airline.iata);
         std::string new_iata = utils::to_upper(std::string(updates["iata"].s()));
         
-        airline_iata_to_id_.erase(old_iata);
+        airline_iata_index_.erase(code_key(old_iata));
         airline.iata = new_iata;
-        if (!new_iata.empty()) {
-            airline_iata_to_id_[new_iata] = airline_id;
-        }
+        airline_iata_index_.assign(code_key(new_iata), airline_id);
     }
 
+    // ICAO change requires index update
+    if (updates.has("icao")) {
+        airline_icao_index_.erase(code_key(airline.icao));
+        airline.icao = updates["icao"].s();
+        airline_icao_index_.assign(code_key(airline.icao), airline_id);
+    }
+
+    change_log_.append(ChangeOp::Update, ChangeEntity::Airline,
+                       std::to_string(airline_id), airline.to_json().dump());
     return true;
 }
 
 bool DataStore::modify_route(int airline_id, int source_airport_id, int dest_airport_id,
                              const crow::json::rvalue& updates) {
-    std::string key = std::to_string(airline_id) + "_" + 
-                     std::to_string(source_airport_id) + "_" + 
-                     std::to_string(dest_airport_id);
+    static const auto op_time = op_histogram("modify_route");
+    metrics::ScopedTimer timer(op_time);
 
-    auto it = std::find_if(routes_.begin(), routes_.end(),
-                          [&key](const Route& r) { return r.get_key() == key; });
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto row = find_route_row(airline_id, source_airport_id, dest_airport_id);
+    if (!row) {
+        return false;
+    }
 
-    if (it == routes_.end()) {
+    // ID changes require validation, before anything is modified
+    int new_airline_id = updates.has("airline_id") ? static_cast<int>(updates["airline_id"].i()) : airline_id;
+    int new_source_id = updates.has("source_airport_id")
+        ? static_cast<int>(updates["source_airport_id"].i()) : source_airport_id;
+    int new_dest_id = updates.has("dest_airport_id")
+        ? static_cast<int>(updates["dest_airport_id"].i()) : dest_airport_id;
+    // Compared by value: a full-body update (as a replica applies it) that
+    // repeats the current ids is an ordinary update, not a re-key
+    bool ids_changed = new_airline_id != airline_id || new_source_id != source_airport_id ||
+                       new_dest_id != dest_airport_id;
+
+    if (new_airline_id != airline_id && airlines_by_id_.find(new_airline_id) == airlines_by_id_.end()) {
+        return false;
+    }
+    if (new_source_id != source_airport_id && airports_by_id_.find(new_source_id) == airports_by_id_.end()) {
+        return false;
+    }
+    if (new_dest_id != dest_airport_id && airports_by_id_.find(new_dest_id) == airports_by_id_.end()) {
         return false;
     }
 
-    Route& route = *it;
-    
+    Route& route = routes_[*row];
+    const Route before = route;
+    std::string key = before.get_key();
+
+    // Any field can change one-hop results (stops filter, response body)
+    invalidate_one_hop({before});
+
     if (updates.has("codeshare")) route.codeshare = updates["codeshare"].s();
     if (updates.has("stops")) route.stops = updates["stops"].i();
     if (updates.has("equipment")) route.equipment = updates["equipment"].s();
+    route.airline_id = new_airline_id;
+    route.source_airport_id = new_source_id;
+    route.dest_airport_id = new_dest_id;
+    route_columns_.update(*row, before, route);
+    hot_.update_route(*row, route);
 
-    // ID changes require validation
-    bool ids_changed = false;
-    int new_airline_id = route.airline_id;
-    int new_source_id = route.source_airport_id;
-    int new_dest_id = route.dest_airport_id;
-
-    if (updates.has("airline_id")) {
-        new_airline_id = updates["airline_id"].i();
-        if (airlines_by_id_.find(new_airline_id) == airlines_by_id_.end()) {
-            return false;
+    if (ids_changed) {
+        // Move the row between the affected rows lists only
+        if (before.source_airport_id != route.source_airport_id) {
+            unlink_row(routes_from_airport_, before.source_airport_id, *row);
+            routes_from_airport_[route.source_airport_id].push_back(*row);
         }
-        ids_changed = true;
-    }
-
-    if (updates.has("source_airport_id")) {
-        new_source_id = updates["source_airport_id"].i();
-        if (airports_by_id_.find(new_source_id) == airports_by_id_.end()) {
-            return false;
+        if (before.dest_airport_id != route.dest_airport_id) {
+            unlink_row(routes_to_airport_, before.dest_airport_id, *row);
+            routes_to_airport_[route.dest_airport_id].push_back(*row);
+        }
+        if (before.airline_id != route.airline_id) {
+            unlink_row(routes_by_airline_, before.airline_id, *row);
+            routes_by_airline_[route.airline_id].push_back(*row);
         }
-        ids_changed = true;
-    }
 
-    if (updates.has("dest_airport_id")) {
-        new_dest_id = updates["dest_airport_id"].i();
-        if (airports_by_id_.find(new_dest_id) == airports_by_id_.end()) {
-            return false;
+        analytics_.remove_route(before, airports_by_id_);
+        analytics_.add_route(route, airports_by_id_);
+        invalidate_one_hop({route});
+        if (before.source_airport_id != route.source_airport_id ||
+            before.dest_airport_id != route.dest_airport_id) {
+            remove_from_reachability({before});
+            if (route_in_graph(route)) {
+                reachability_.add_edge(route.source_airport_id, route.dest_airport_id);
+            }
         }
-        ids_changed = true;
-    }
 
-    if (ids_changed) {
-        route.airline_id = new_airline_id;
-        route.source_airport_id = new_source_id;
-        route.dest_airport_id = new_dest_id;
-        rebuild_route_indexes();
+        // The key changed, so consumers see it as a delete plus an insert;
+        // replicas replay the pair as this modify_route
+        change_log_.append(ChangeOp::Delete, ChangeEntity::Route, key, "", true);
+        change_log_.append(ChangeOp::Insert, ChangeEntity::Route,
+                           route.get_key(), route.to_json().dump());
+    } else {
+        change_log_.append(ChangeOp::Update, ChangeEntity::Route, key, route.to_json().dump());
     }
 
     return true;
 }
 
 // 4. One-hop route finding
-std::vector<OneHopRoute> DataStore::find_one_hop_routes(
-    const std::string& source_iata, 
-    const std::string& dest_iata) const {
-    
-    auto source_opt = get_airport_by_iata(source_iata);
-    auto dest_opt = get_airport_by_iata(dest_iata);
-    
-    if (!source_opt || !dest_opt) {
+std::vector<OneHopRouteRef> DataStore::ReadView::one_hop_routes(
+    const Airport& source, const Airport& dest, const utils::Deadline* deadline) const {
+    static const auto op_time = op_histogram("find_one_hop_routes");
+    metrics::ScopedTimer timer(op_time);
+
+    int source_id = source.id;
+    int dest_id = dest.id;
+    const auto& routes = store_->routes_;
+    const auto& hot = store_->hot_;
+    const auto& routes_from_airport = store_->routes_from_airport_;
+
+    std::vector<OneHopRouteRef> results;
+
+    // Unreachable, or every path needs more than two legs: nothing to find
+    static const auto rejected = metrics::counter(
+        "flight_one_hop_rejected_total", "", "One-hop searches rejected by the reachability labeling");
+    int min_legs = store_->reachability_.hop_lower_bound(source_id, dest_id);
+    if (min_legs < 0 || min_legs > 2) {
+        rejected.inc();
         return {};
     }
 
-    int source_id = source_opt->id;
-    int dest_id = dest_opt->id;
-
-    std::vector<OneHopRoute> results;
-
     // Find all routes from source
-    auto from_source_it = routes_from_airport_.find(source_id);
-    if (from_source_it == routes_from_airport_.end()) {
+    auto from_source_it = routes_from_airport.find(source_id);
+    if (from_source_it == routes_from_airport.end()) {
+        return {};
+    }
+
+    // Search effort, exported as histograms once the search completes
+    static const auto intermediates_hist = metrics::histogram(
+        "flight_one_hop_intermediates", "", "Intermediate airports examined per one-hop search");
+    static const auto edges_hist = metrics::histogram(
+        "flight_one_hop_edges_scanned", "", "Second-leg routes scanned per one-hop search");
+    static const auto results_hist = metrics::histogram(
+        "flight_one_hop_results", "", "Connections returned per one-hop search");
+    uint64_t intermediates_examined = 0;
+    uint64_t edges_scanned = 0;
+
+    // The scan reads hot records only; full routes and airports are
+    // touched for the connections found
+    const AirportHot* source_hot = hot.airport(source_id);
+    const AirportHot* dest_hot = hot.airport(dest_id);
+    if (!source_hot || !dest_hot) {
         return {};
     }
 
     // For each intermediate airport reachable from source
     for (size_t first_leg_idx : from_source_it->second) {
-        const Route& first_leg = routes_[first_leg_idx];
-        
+        const RouteHot& first_leg = hot.route(first_leg_idx);
+
         // Only consider 0-stop routes
         if (first_leg.stops != 0) continue;
+        if (deadline && deadline->expired()) break;
 
         int intermediate_id = first_leg.dest_airport_id;
-        
+
         // Skip if intermediate is the destination (direct flight)
         if (intermediate_id == dest_id) continue;
 
         // Find routes from intermediate to destination
-        auto from_intermediate_it = routes_from_airport_.find(intermediate_id);
-        if (from_intermediate_it == routes_from_airport_.end()) continue;
+        auto from_intermediate_it = routes_from_airport.find(intermediate_id);
+        if (from_intermediate_it == routes_from_airport.end()) continue;
 
+        intermediates_examined++;
+        edges_scanned += from_intermediate_it->second.size();
+
+        const Airport* intermediate_airport = nullptr;
+        double total_distance = 0;
         for (size_t second_leg_idx : from_intermediate_it->second) {
-            const Route& second_leg = routes_[second_leg_idx];
-            
+            const RouteHot& second_leg = hot.route(second_leg_idx);
+
             // Check if this goes to our destination with 0 stops
             if (second_leg.dest_airport_id == dest_id && second_leg.stops == 0) {
-                auto intermediate_airport = get_airport_by_id(intermediate_id);
-                if (!intermediate_airport) continue;
-
-                // Calculate total distance
-                double leg1_distance = calculate_distance_miles(*source_opt, *intermediate_airport);
-                double leg2_distance = calculate_distance_miles(*intermediate_airport, *dest_opt);
-                double total_distance = leg1_distance + leg2_distance;
-
-                OneHopRoute one_hop;
-                one_hop.first_leg = first_leg;
-                one_hop.second_leg = second_leg;
-                one_hop.total_distance_miles = total_distance;
-                one_hop.intermediate_airport_iata = intermediate_airport->iata;
-
-                results.push_back(one_hop);
+                // Same distance for every connection through this airport
+                if (!intermediate_airport) {
+                    const AirportHot* intermediate_hot = hot.airport(intermediate_id);
+                    if (!intermediate_hot) break;
+                    intermediate_airport = store_->find_airport_by_id(intermediate_id);
+                    total_distance = store_->calculate_distance_miles(*source_hot, *intermediate_hot) +
+                                     store_->calculate_distance_miles(*intermediate_hot, *dest_hot);
+                }
+
+                results.push_back({&routes[first_leg_idx], &routes[second_leg_idx],
+                                   intermediate_airport, total_distance});
             }
         }
     }
 
     // Sort by total distance (ascending)
     std::sort(results.begin(), results.end(),
-              [](const OneHopRoute& a, const OneHopRoute& b) {
+              [](const OneHopRouteRef& a, const OneHopRouteRef& b) {
                   return a.total_distance_miles < b.total_distance_miles;
               });
 
+    intermediates_hist.observe(intermediates_examined);
+    edges_hist.observe(edges_scanned);
+    results_hist.observe(results.size());
+
+    slow_log::QueryPlan plan;
+    plan.one_hop = true;
+    plan.intermediates_examined = intermediates_examined;
+    plan.edges_scanned = edges_scanned;
+    plan.results = results.size();
+    slow_log::record_plan(plan);
+
     return results;
 }
 
+OneHopCache::Result DataStore::ReadView::one_hop(const Airport& source, const Airport& dest,
+                                                const utils::Deadline* deadline) const {
+    if (auto cached = store_->one_hop_cache_.find(source.id, dest.id)) {
+        return cached;
+    }
+
+    auto results = std::make_shared<std::vector<OneHopRoute>>();
+    std::vector<int> intermediates;
+    for (const auto& ref : one_hop_routes(source, dest, deadline)) {
+        results->push_back({*ref.first_leg, *ref.second_leg, ref.total_distance_miles,
+                            ref.intermediate_airport->iata});
+        intermediates.push_back(ref.intermediate_airport->id);
+    }
+    std::sort(intermediates.begin(), intermediates.end());
+    intermediates.erase(std::unique(intermediates.begin(), intermediates.end()), intermediates.end());
+
+    if (!deadline || !deadline->expired()) {
+        store_->one_hop_cache_.insert(source.id, dest.id, results, intermediates);
+    }
+    return results;
+}
+
+std::vector<OneHopRoute> DataStore::find_one_hop_routes(
+    const std::string& source_iata,
+    const std::string& dest_iata) const {
+    auto view = read();
+    auto source = view.airport_by_iata(source_iata);
+    auto dest = view.airport_by_iata(dest_iata);
+
+    if (!source || !dest) {
+        return {};
+    }
+
+    return *view.one_hop(*source, *dest);
+}
+
 // Distance calculation using Haversine formula
 double DataStore::calculate_distance_miles(const Airport& a1, const Airport& a2) const {
     return haversine_distance(a1.latitude, a1.longitude, a2.latitude, a2.longitude);
 }
 
+double DataStore::calculate_distance_miles(const AirportHot& a1, const AirportHot& a2) const {
+    return haversine_distance(a1.latitude, a1.longitude, a2.latitude, a2.longitude);
+}
+
 double DataStore::haversine_distance(double lat1, double lon1, double lat2, double lon2) const {
     const double R = 3958.8; // Earth radius in miles
     
@@ -2,20 +2,24 @@
 #include "../models/airport.hpp"
 #include "../models/airline.hpp"
 #include "../models/route.hpp"
+#include "change_log.hpp"
+#include "centrality.hpp"
+#include "code_index.hpp"
+#include "hot_records.hpp"
+#include "network_analytics.hpp"
+#include "one_hop_cache.hpp"
+#include "reachability.hpp"
+#include "route_columns.hpp"
+#include "version_pins.hpp"
+#include "../utils/deadline.hpp"
 #include <unordered_map>
 #include <map>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
 #include <memory>
-
-// Structure for one-hop route results
-struct OneHopRoute {
-    Route first_leg;
-    Route second_leg;
-    double total_distance_miles;
-    std::string intermediate_airport_iata;
-};
+#include <shared_mutex>
 
 // Result structures for reports
 struct AirportRouteCount {
@@ -28,18 +32,90 @@ struct AirlineRouteCount {
     int route_count;
 };
 
+// Borrowed-view counterparts of the result structures above. The pointers
+// refer into the store and are valid for the lifetime of the ReadView
+// that produced them.
+struct OneHopRouteRef {
+    const Route* first_leg;
+    const Route* second_leg;
+    const Airport* intermediate_airport;
+    double total_distance_miles;
+};
+
+struct AirportRouteRef {
+    const Airport* airport;
+    int route_count;
+};
+
+struct AirlineRouteRef {
+    const Airline* airline;
+    int route_count;
+};
+
+// Packed code -> id entries of the four code indexes
+struct CodeMaps {
+    std::vector<std::pair<uint32_t, int>> airport_iata;
+    std::vector<std::pair<uint32_t, int>> airport_icao;
+    std::vector<std::pair<uint32_t, int>> airline_iata;
+    std::vector<std::pair<uint32_t, int>> airline_icao;
+};
+
+// Copy of every table as of one change-log sequence number; a replica
+// loads it and then applies the primary's changes after `seq`. Codes
+// repeat in the data, and which record owns a code depends on load order
+// and later writes, so the indexes travel as they are rather than being
+// rebuilt from the rows.
+struct StoreSnapshot {
+    uint64_t seq = 0;
+    uint64_t generation = 0;  // Of the source's change log; not restored on load
+    std::vector<Airport> airports;
+    std::vector<Airline> airlines;
+    std::vector<Route> routes;
+    CodeMaps codes;
+};
+
 class DataStore {
 public:
+    class ReadView;
+
     DataStore();
+
+    // Shared read guard with copy-free accessors. Writers are blocked while
+    // any ReadView is alive, so keep it scoped to a single request.
+    ReadView read() const;
+
+    // As read(), but at an earlier `version` if one is pinned (see
+    // version_pins.hpp); nullopt reads the current data. Nullopt when that
+    // version is no longer held.
+    std::optional<ReadView> read_at(std::optional<uint64_t> version) const;
+
+    // View of a frozen copy of the current version, for long reads that
+    // must not hold up writers (exports). Shares a pinned copy of that
+    // version if there is one, otherwise builds one as pin() does.
+    ReadView read_frozen() const;
+
+    // Keep the current version readable through read_at() for `ttl`, or
+    // until unpinned; nullopt when too many versions are pinned already
+    std::optional<VersionPins::Pin> pin(std::chrono::seconds ttl);
+    bool unpin(uint64_t pin_id) { return version_pins_.remove(pin_id); }
+    std::vector<VersionPins::Pin> pins() const { return version_pins_.pins(); }
+    size_t retained_versions() const { return version_pins_.retained_versions(); }
     
     // Load data from CSV files
     bool load_data(const std::string& airports_path, 
                    const std::string& airlines_path, 
                    const std::string& routes_path);
 
+    // Replication: copy the tables consistently with the change log, and
+    // replace them wholesale, continuing the change log after snapshot.seq
+    StoreSnapshot snapshot() const;
+    bool load_snapshot(StoreSnapshot snapshot);
+
     // 1. Individual Entity Retrieval
     std::optional<Airline> get_airline_by_iata(const std::string& iata) const;
     std::optional<Airport> get_airport_by_iata(const std::string& iata) const;
+    std::optional<Airline> get_airline_by_icao(const std::string& icao) const;
+    std::optional<Airport> get_airport_by_icao(const std::string& icao) const;
     
     // Helper methods for ID-based retrieval
     std::optional<Airline> get_airline_by_id(int id) const;
@@ -75,18 +151,40 @@ public:
                                                    const std::string& dest_iata) const;
 
     // Utility
-    size_t get_airport_count() const { return airports_by_id_.size(); }
-    size_t get_airline_count() const { return airlines_by_id_.size(); }
-    size_t get_route_count() const { return routes_.size(); }
+    size_t get_airport_count() const;
+    size_t get_airline_count() const;
+    size_t get_route_count() const;
+
+    OneHopCache::Stats get_one_hop_cache_stats() const { return one_hop_cache_.stats(); }
+
+    // Memory of the hot records against the full ones (see hot_records.hpp)
+    HotRecords::Footprint get_hot_footprint() const;
+
+    // Change feed: every successful mutation is recorded with a sequence number
+    const ChangeLog& get_change_log() const { return change_log_; }
+
+    // Latest airport centrality computed by the background job (may lag
+    // the data, see CentralityScores::version); null until the first run
+    std::shared_ptr<const CentralityScores> get_centrality() const {
+        return std::atomic_load(&centrality_);
+    }
+    void publish_centrality(std::shared_ptr<const CentralityScores> scores) {
+        std::atomic_store(&centrality_, std::move(scores));
+    }
 
 private:
+    // Readers take this shared (via ReadView), mutations take it exclusively
+    mutable std::shared_mutex mutex_;
+
     // Primary storage: ID-based lookups
     std::unordered_map<int, Airport> airports_by_id_;
     std::unordered_map<int, Airline> airlines_by_id_;
     
-    // Secondary indexes: IATA-based lookups
-    std::unordered_map<std::string, int> airport_iata_to_id_;
-    std::unordered_map<std::string, int> airline_iata_to_id_;
+    // Secondary indexes: IATA/ICAO code -> id, keyed by pack_code()
+    CodeIndex airport_iata_index_;
+    CodeIndex airline_iata_index_;
+    CodeIndex airport_icao_index_;
+    CodeIndex airline_icao_index_;
     
     // Route storage and indexes
     std::vector<Route> routes_;
@@ -101,8 +199,130 @@ private:
     // airline_id -> vector of routes operated by that airline
     std::unordered_map<int, std::vector<size_t>> routes_by_airline_;
 
-    // Helper methods
+    // Columnar copy of routes_ for filter scans (/api/routes?...)
+    RouteColumns route_columns_;
+
+    // Compact copies of the fields graph queries read; the full records
+    // above are only touched for results
+    HotRecords hot_;
+
+    // Hub/country/airline statistics (/api/analytics), updated per route change
+    NetworkAnalytics analytics_;
+
+    // SCC / reachability labeling over routes between known airports
+    Reachability reachability_;
+
+    // Filled by readers; mutations evict the pairs they touch
+    mutable OneHopCache one_hop_cache_;
+
+    // Recent mutations for incremental sync (/api/changes)
+    ChangeLog change_log_;
+
+    // Swapped atomically; not guarded by mutex_
+    std::shared_ptr<const CentralityScores> centrality_;
+
+    // Frozen copies for as-of reads; has its own lock
+    mutable VersionPins version_pins_;
+
+    // Helper methods (callers hold mutex_)
+    const Airport* find_airport_by_id(int id) const;
+    const Airline* find_airline_by_id(int id) const;
+    const Airport* find_airport_by_code(const CodeIndex& index, std::string_view code) const;
+    const Airline* find_airline_by_code(const CodeIndex& index, std::string_view code) const;
+    // Code indexes come from `codes`, or from the rows in order (last one
+    // wins) when it is null
+    void replace_tables(std::vector<Airport> airports, std::vector<Airline> airlines,
+                        std::vector<Route> routes, const CodeMaps* codes);
+    // Copy of the current version for pin() and read_frozen(), shared with
+    // any copy of it already held; sets the version it holds
+    VersionPins::Snapshot current_copy(uint64_t& generation, uint64_t& version) const;
     void rebuild_route_indexes();
+    std::optional<size_t> find_route_row(int airline_id, int source_airport_id, int dest_airport_id) const;
+    void erase_route_row(size_t row);
+    // Logged as partial: the airport/airline delete that follows completes them
+    void record_route_removals(const std::vector<Route>& removed);
+    bool route_in_graph(const Route& route) const;
+    void remove_from_reachability(const std::vector<Route>& removed);
+    void invalidate_one_hop(const std::vector<Route>& changed);
     double calculate_distance_miles(const Airport& a1, const Airport& a2) const;
+    double calculate_distance_miles(const AirportHot& a1, const AirportHot& a2) const;
     double haversine_distance(double lat1, double lon1, double lat2, double lon2) const;
-};
\ No newline at end of file
+};
+
+// Copy-free read access to a DataStore. Holds a shared lock on the store
+// for its whole lifetime; every pointer it returns stays valid until the
+// view is destroyed.
+class DataStore::ReadView {
+public:
+    // 1. Individual Entity Retrieval
+    // Codes are matched case-insensitively without allocating
+    const Airline* airline_by_iata(std::string_view iata) const { return store_->find_airline_by_code(store_->airline_iata_index_, iata); }
+    const Airport* airport_by_iata(std::string_view iata) const { return store_->find_airport_by_code(store_->airport_iata_index_, iata); }
+    const Airline* airline_by_icao(std::string_view icao) const { return store_->find_airline_by_code(store_->airline_icao_index_, icao); }
+    const Airport* airport_by_icao(std::string_view icao) const { return store_->find_airport_by_code(store_->airport_icao_index_, icao); }
+    const Airline* airline_by_id(int id) const { return store_->find_airline_by_id(id); }
+    const Airport* airport_by_id(int id) const { return store_->find_airport_by_id(id); }
+
+    // 2.1 Reports Ordered by # Routes
+    std::vector<AirportRouteRef> airports_by_airline_routes(const Airline& airline) const;
+    std::vector<AirlineRouteRef> airlines_by_airport_routes(const Airport& airport) const;
+
+    // 2.2 Reports Ordered by IATA Codes
+    std::vector<const Airline*> airlines_sorted_by_iata() const;
+    std::vector<const Airport*> airports_sorted_by_iata() const;
+
+    // Every record, for exports: airlines and airports in id order, routes
+    // in table order
+    std::vector<const Airline*> airlines_by_id() const;
+    std::vector<const Airport*> airports_by_id() const;
+    const std::vector<Route>& routes() const { return store_->routes_; }
+
+    // Routes matching every predicate in `filter`, in table order
+    std::vector<const Route*> filter_routes(const RouteFilter& filter) const;
+
+    // Materialized network statistics, current as of version()
+    const NetworkAnalytics& analytics() const { return store_->analytics_; }
+
+    // Latest background centrality result for this view's store; a pinned
+    // version keeps the result it was pinned with
+    std::shared_ptr<const CentralityScores> centrality() const { return store_->get_centrality(); }
+
+    // Sequence number of the last mutation this view can see
+    uint64_t version() const { return store_->change_log_.current_seq(); }
+
+    // The store's change-log generation (see ChangeLog::generation()) when
+    // the view was taken; caches key by it together with version()
+    uint64_t generation() const { return generation_; }
+
+    // Whether this view reads a frozen copy rather than the live store
+    bool frozen() const { return snapshot_ != nullptr; }
+
+    size_t route_count() const { return store_->routes_.size(); }
+
+    // Whether any sequence of routes leads from source to dest, and the
+    // fewest legs it can take (-1 if unreachable); both O(1)
+    bool reachable(const Airport& source, const Airport& dest) const { return store_->reachability_.reachable(source.id, dest.id); }
+    int hop_lower_bound(const Airport& source, const Airport& dest) const { return store_->reachability_.hop_lower_bound(source.id, dest.id); }
+
+    // 4. One-hop Report
+    // Stops early, with partial results, once `deadline` expires
+    std::vector<OneHopRouteRef> one_hop_routes(const Airport& source, const Airport& dest,
+                                               const utils::Deadline* deadline = nullptr) const;
+
+    // The same connections by value, served from the result cache when
+    // possible. Results cut short by `deadline` are not cached.
+    OneHopCache::Result one_hop(const Airport& source, const Airport& dest,
+                                const utils::Deadline* deadline = nullptr) const;
+
+private:
+    friend class DataStore;
+    explicit ReadView(const DataStore& store) : store_(&store), lock_(store.mutex_) {
+        generation_ = store.change_log_.generation();
+    }
+
+    const DataStore* store_;
+    uint64_t generation_ = 0;
+    // Keeps a pinned copy alive for views from read_at(); released after lock_
+    std::shared_ptr<const DataStore> snapshot_;
+    std::shared_lock<std::shared_mutex> lock_;
+};
@@ -0,0 +1,129 @@
+#include "hot_records.hpp"
+#include "code_index.hpp"
+#include "../utils/string_utils.hpp"
+
+namespace {
+
+RouteHot route_hot(const Route& route) {
+    return {route.airline_id, route.source_airport_id, route.dest_airport_id, route.stops};
+}
+
+AirportHot airport_hot(const Airport& airport) {
+    uint32_t iata = utils::is_null(airport.iata) ? 0 : pack_code(airport.iata);
+    return {airport.id, iata, airport.latitude, airport.longitude};
+}
+
+// Heap bytes behind a string, 0 while it fits the small-string buffer
+size_t heap_bytes(const std::string& s) {
+    return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+uint32_t full_bytes(const Route& r) {
+    return static_cast<uint32_t>(sizeof(Route) + heap_bytes(r.airline_iata) + heap_bytes(r.source_airport_iata) +
+                                 heap_bytes(r.dest_airport_iata) + heap_bytes(r.codeshare) +
+                                 heap_bytes(r.equipment));
+}
+
+uint32_t full_bytes(const Airport& a) {
+    return static_cast<uint32_t>(sizeof(Airport) + heap_bytes(a.name) + heap_bytes(a.city) +
+                                 heap_bytes(a.country) + heap_bytes(a.iata) + heap_bytes(a.icao) +
+                                 heap_bytes(a.dst) + heap_bytes(a.tz_database) + heap_bytes(a.type) +
+                                 heap_bytes(a.source));
+}
+
+} // namespace
+
+void HotRecords::build_routes(const std::vector<Route>& routes) {
+    routes_.clear();
+    route_full_.clear();
+    route_full_total_ = 0;
+    routes_.reserve(routes.size());
+    route_full_.reserve(routes.size());
+    for (const auto& route : routes) append_route(route);
+}
+
+void HotRecords::append_route(const Route& route) {
+    routes_.push_back(route_hot(route));
+    route_full_.push_back(full_bytes(route));
+    route_full_total_ += route_full_.back();
+}
+
+void HotRecords::update_route(size_t row, const Route& route) {
+    routes_[row] = route_hot(route);
+    route_full_total_ -= route_full_[row];
+    route_full_[row] = full_bytes(route);
+    route_full_total_ += route_full_[row];
+}
+
+void HotRecords::swap_remove_route(size_t row) {
+    route_full_total_ -= route_full_[row];
+    routes_[row] = routes_.back();
+    routes_.pop_back();
+    route_full_[row] = route_full_.back();
+    route_full_.pop_back();
+}
+
+void HotRecords::build_airports(const std::unordered_map<int, Airport>& airports) {
+    airports_.clear();
+    airport_full_.clear();
+    airport_full_total_ = 0;
+    direct_slots_.clear();
+    sparse_slots_.clear();
+    airports_.reserve(airports.size());
+    airport_full_.reserve(airports.size());
+    for (const auto& [id, airport] : airports) put_airport(airport);
+}
+
+void HotRecords::put_airport(const Airport& airport) {
+    int32_t slot = slot_of(airport.id);
+    if (slot >= 0) {
+        airports_[slot] = airport_hot(airport);
+        airport_full_total_ -= airport_full_[slot];
+        airport_full_[slot] = full_bytes(airport);
+        airport_full_total_ += airport_full_[slot];
+        return;
+    }
+    set_slot(airport.id, static_cast<int32_t>(airports_.size()));
+    airports_.push_back(airport_hot(airport));
+    airport_full_.push_back(full_bytes(airport));
+    airport_full_total_ += airport_full_.back();
+}
+
+void HotRecords::remove_airport(int id) {
+    int32_t slot = slot_of(id);
+    if (slot < 0) return;
+    // Keep the array dense: the last airport takes the freed slot
+    airport_full_total_ -= airport_full_[slot];
+    const AirportHot& last = airports_.back();
+    if (last.id != id) {
+        airports_[slot] = last;
+        airport_full_[slot] = airport_full_.back();
+        set_slot(last.id, slot);
+    }
+    airports_.pop_back();
+    airport_full_.pop_back();
+    set_slot(id, -1);
+}
+
+void HotRecords::set_slot(int id, int32_t slot) {
+    if (id >= 0 && id < kDirectIds) {
+        if (static_cast<size_t>(id) >= direct_slots_.size()) {
+            if (slot < 0) return;
+            direct_slots_.resize(id + 1, -1);
+        }
+        direct_slots_[id] = slot;
+    } else if (slot < 0) {
+        sparse_slots_.erase(id);
+    } else {
+        sparse_slots_[id] = slot;
+    }
+}
+
+HotRecords::Footprint HotRecords::footprint() const {
+    Footprint result;
+    result.airport_hot_bytes = airports_.size() * sizeof(AirportHot) + direct_slots_.size() * sizeof(int32_t);
+    result.route_hot_bytes = routes_.size() * sizeof(RouteHot);
+    result.airport_full_bytes = airport_full_total_;
+    result.route_full_bytes = route_full_total_;
+    return result;
+}
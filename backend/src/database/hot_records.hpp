@@ -0,0 +1,88 @@
+#pragma once
+#include "../models/airport.hpp"
+#include "../models/route.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Hot/cold split of the entity tables for graph queries.
+//
+// One-hop search and the route-count reports read a few fields of many
+// records: a route's airline, endpoints and stops, and an airport's id,
+// code and coordinates. In Route and Airport those fields sit among
+// several std::strings, so each record visited drags whole cache lines of
+// text the query never reads. HotRecords keeps just those fields packed
+// in dense arrays; the full objects in DataStore's tables become the cold
+// records, read only for the rows a query returns.
+//
+// Owned by DataStore and updated under its exclusive lock.
+struct RouteHot {
+    int32_t airline_id;
+    int32_t source_airport_id;
+    int32_t dest_airport_id;
+    int32_t stops;
+};
+
+struct AirportHot {
+    int32_t id;
+    uint32_t iata;  // pack_code() of the IATA code, 0 if none
+    double latitude;
+    double longitude;
+};
+
+class HotRecords {
+public:
+    // Bytes of the hot arrays against the full records they summarize
+    // (object size plus heap-allocated string bytes). The full sizes are
+    // running totals kept by the update calls, so reading them is O(1).
+    struct Footprint {
+        size_t airport_hot_bytes = 0;
+        size_t airport_full_bytes = 0;
+        size_t route_hot_bytes = 0;
+        size_t route_full_bytes = 0;
+    };
+
+    // Routes mirror DataStore::routes_ row for row, including its
+    // swap-with-last removal
+    void build_routes(const std::vector<Route>& routes);
+    void append_route(const Route& route);
+    void update_route(size_t row, const Route& route);
+    void swap_remove_route(size_t row);
+    const RouteHot& route(size_t row) const { return routes_[row]; }
+
+    // Airports live in dense slots, found by id
+    void build_airports(const std::unordered_map<int, Airport>& airports);
+    void put_airport(const Airport& airport);
+    void remove_airport(int id);
+    const AirportHot* airport(int id) const {
+        int32_t slot = slot_of(id);
+        return slot < 0 ? nullptr : &airports_[slot];
+    }
+
+    Footprint footprint() const;
+
+private:
+    // Ids below this map to slots through a flat array, larger ones
+    // through a hash map
+    static constexpr int kDirectIds = 1 << 20;
+
+    int32_t slot_of(int id) const {
+        if (id >= 0 && static_cast<size_t>(id) < direct_slots_.size()) return direct_slots_[id];
+        if (id >= 0 && id < kDirectIds) return -1;
+        auto it = sparse_slots_.find(id);
+        return it == sparse_slots_.end() ? -1 : it->second;
+    }
+    void set_slot(int id, int32_t slot);
+
+    std::vector<RouteHot> routes_;
+    std::vector<AirportHot> airports_;
+
+    // Full-record bytes per route row and per airport slot, and their sums
+    std::vector<uint32_t> route_full_;
+    std::vector<uint32_t> airport_full_;
+    size_t route_full_total_ = 0;
+    size_t airport_full_total_ = 0;
+    std::vector<int32_t> direct_slots_;  // id -> slot, -1 if absent
+    std::unordered_map<int, int32_t> sparse_slots_;
+};
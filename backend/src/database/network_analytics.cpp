@@ -0,0 +1,130 @@
+#include "network_analytics.hpp"
+#include "../utils/parallel.hpp"
+#include <algorithm>
+
+namespace {
+
+const std::string& country_of(int airport_id, const NetworkAnalytics::AirportMap& airports) {
+    static const std::string kUnknown;
+    auto it = airports.find(airport_id);
+    return it != airports.end() ? it->second.country : kUnknown;
+}
+
+// Add `delta` to a counter and drop the entry once it reaches zero
+template <typename Map, typename Key>
+void bump(Map& map, const Key& key, int delta) {
+    auto it = map.emplace(key, 0).first;
+    it->second += delta;
+    if (it->second == 0) map.erase(it);
+}
+
+} // namespace
+
+void NetworkAnalytics::build(const std::vector<Route>& routes, const AirportMap& airports) {
+    // Each chunk counts its slice of the route table independently, then
+    // the partial counters are summed. Distinct-destination counts do not
+    // add up across chunks, so they are derived from the merged edges.
+    std::vector<NetworkAnalytics> parts(utils::default_parallelism());
+    size_t used = utils::parallel_chunks(routes.size(), parts.size(),
+        [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                parts[chunk].apply(routes[i], 1, airports);
+            }
+        });
+
+    airports_.clear();
+    airlines_.clear();
+    country_routes_.clear();
+    edges_.clear();
+
+    for (size_t c = 0; c < used; ++c) {
+        auto& part = parts[c];
+        for (const auto& [id, stats] : part.airports_) {
+            auto& merged = airports_[id];
+            merged.routes_out += stats.routes_out;
+            merged.routes_in += stats.routes_in;
+        }
+        for (auto& [id, stats] : part.airlines_) {
+            auto& merged = airlines_[id];
+            merged.routes += stats.routes;
+            for (const auto& [airport_id, count] : stats.airports) {
+                merged.airports[airport_id] += count;
+            }
+        }
+        for (const auto& [countries, count] : part.country_routes_) {
+            country_routes_[countries] += count;
+        }
+        for (const auto& [edge, count] : part.edges_) {
+            edges_[edge] += count;
+        }
+    }
+
+    for (const auto& [edge, count] : edges_) {
+        airports_[static_cast<int>(edge >> 32)].destinations++;
+    }
+}
+
+void NetworkAnalytics::add_route(const Route& route, const AirportMap& airports) {
+    apply(route, 1, airports);
+}
+
+void NetworkAnalytics::remove_route(const Route& route, const AirportMap& airports) {
+    apply(route, -1, airports);
+}
+
+void NetworkAnalytics::apply(const Route& route, int delta, const AirportMap& airports) {
+    auto& source = airports_[route.source_airport_id];
+    source.routes_out += delta;
+    airports_[route.dest_airport_id].routes_in += delta;
+
+    int& multiplicity = edges_[edge_key(route.source_airport_id, route.dest_airport_id)];
+    if (multiplicity == 0 && delta > 0) source.destinations++;
+    multiplicity += delta;
+    if (multiplicity == 0) {
+        source.destinations--;
+        edges_.erase(edge_key(route.source_airport_id, route.dest_airport_id));
+    }
+
+    for (int airport_id : {route.source_airport_id, route.dest_airport_id}) {
+        const auto& stats = airports_[airport_id];
+        if (stats.routes_out == 0 && stats.routes_in == 0) airports_.erase(airport_id);
+    }
+
+    auto& airline = airlines_[route.airline_id];
+    airline.routes += delta;
+    bump(airline.airports, route.source_airport_id, delta);
+    bump(airline.airports, route.dest_airport_id, delta);
+    if (airline.routes == 0) airlines_.erase(route.airline_id);
+
+    bump(country_routes_, std::make_pair(country_of(route.source_airport_id, airports),
+                                         country_of(route.dest_airport_id, airports)), delta);
+}
+
+void NetworkAnalytics::change_airport_country(int airport_id, const std::string& old_country,
+                                              const std::string& new_country,
+                                              const std::vector<const Route*>& routes,
+                                              const AirportMap& airports) {
+    auto country = [&](int id, const std::string& own) -> const std::string& {
+        return id == airport_id ? own : country_of(id, airports);
+    };
+    for (const Route* route : routes) {
+        bump(country_routes_, std::make_pair(country(route->source_airport_id, old_country),
+                                             country(route->dest_airport_id, old_country)), -1);
+        bump(country_routes_, std::make_pair(country(route->source_airport_id, new_country),
+                                             country(route->dest_airport_id, new_country)), 1);
+    }
+}
+
+std::vector<NetworkAnalytics::DegreeBucket> NetworkAnalytics::degree_distribution() const {
+    std::map<int, int> buckets;
+    for (const auto& [id, stats] : airports_) {
+        buckets[stats.destinations]++;
+    }
+
+    std::vector<DegreeBucket> distribution;
+    distribution.reserve(buckets.size());
+    for (const auto& [degree, count] : buckets) {
+        distribution.push_back({degree, count});
+    }
+    return distribution;
+}
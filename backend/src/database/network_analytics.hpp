@@ -0,0 +1,71 @@
+#pragma once
+#include "../models/airport.hpp"
+#include "../models/route.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Materialized network statistics behind /api/analytics. Built once from
+// the full route table (in parallel), then kept current by applying each
+// route insert/remove as a delta, so queries only sort what is already
+// counted.
+//
+// Owned by DataStore and guarded by its lock like the other indexes.
+class NetworkAnalytics {
+public:
+    using AirportMap = std::unordered_map<int, Airport>;
+
+    struct AirportStats {
+        int routes_out = 0;
+        int routes_in = 0;
+        int destinations = 0;  // Distinct airports reachable nonstop
+    };
+
+    struct AirlineStats {
+        int routes = 0;
+        std::unordered_map<int, int> airports;  // airport_id -> routes touching it
+    };
+
+    struct DegreeBucket {
+        int degree;
+        int airports;
+    };
+
+    void build(const std::vector<Route>& routes, const AirportMap& airports);
+
+    // Route deltas; `airports` supplies the endpoint countries
+    void add_route(const Route& route, const AirportMap& airports);
+    void remove_route(const Route& route, const AirportMap& airports);
+
+    // Move an airport's routes between country-matrix cells
+    void change_airport_country(int airport_id, const std::string& old_country,
+                                const std::string& new_country,
+                                const std::vector<const Route*>& routes,
+                                const AirportMap& airports);
+
+    const std::unordered_map<int, AirportStats>& airport_stats() const { return airports_; }
+    const std::unordered_map<int, AirlineStats>& airline_stats() const { return airlines_; }
+    const std::map<std::pair<std::string, std::string>, int>& country_matrix() const {
+        return country_routes_;
+    }
+
+    // Number of airports per distinct-destination count, ascending
+    std::vector<DegreeBucket> degree_distribution() const;
+
+private:
+    void apply(const Route& route, int delta, const AirportMap& airports);
+
+    static uint64_t edge_key(int source_id, int dest_id) {
+        return (uint64_t(uint32_t(source_id)) << 32) | uint32_t(dest_id);
+    }
+
+    std::unordered_map<int, AirportStats> airports_;
+    std::unordered_map<int, AirlineStats> airlines_;
+    std::map<std::pair<std::string, std::string>, int> country_routes_;
+
+    // Routes per (source, dest) pair, for distinct-destination counts
+    std::unordered_map<uint64_t, int> edges_;
+};
@@ -0,0 +1,130 @@
+#include "one_hop_cache.hpp"
+#include <algorithm>
+
+namespace {
+
+void unindex(std::unordered_map<int, std::unordered_set<uint64_t>>& index, int airport_id,
+             uint64_t key) {
+    auto it = index.find(airport_id);
+    if (it == index.end()) return;
+    it->second.erase(key);
+    if (it->second.empty()) index.erase(it);
+}
+
+} // namespace
+
+OneHopCache::OneHopCache(size_t capacity)
+    : shard_capacity_(std::max<size_t>(1, capacity / kShards)) {}
+
+OneHopCache::Result OneHopCache::find(int source_id, int dest_id) {
+    uint64_t key = pair_key(source_id, dest_id);
+    auto& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->result;
+}
+
+void OneHopCache::insert(int source_id, int dest_id, Result result,
+                         const std::vector<int>& intermediates) {
+    uint64_t key = pair_key(source_id, dest_id);
+    auto& shard = shard_for(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // Two readers may race to fill the same pair; the results are equal
+    if (shard.entries.count(key)) return;
+
+    shard.lru.push_front({key, std::move(result), intermediates});
+    shard.entries[key] = shard.lru.begin();
+    shard.by_source[source_id].insert(key);
+    shard.by_dest[dest_id].insert(key);
+    for (int intermediate : intermediates) {
+        shard.by_intermediate[intermediate].insert(key);
+    }
+
+    while (shard.entries.size() > shard_capacity_) {
+        erase(shard, std::prev(shard.lru.end()));
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void OneHopCache::invalidate_route(int source_id, int dest_id) {
+    std::vector<uint64_t> keys;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        keys.clear();
+        collect(shard.by_source, source_id, keys);
+        collect(shard.by_dest, dest_id, keys);
+        erase_keys(shard, keys);
+    }
+}
+
+void OneHopCache::invalidate_airport(int airport_id) {
+    std::vector<uint64_t> keys;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        keys.clear();
+        collect(shard.by_source, airport_id, keys);
+        collect(shard.by_dest, airport_id, keys);
+        collect(shard.by_intermediate, airport_id, keys);
+        erase_keys(shard, keys);
+    }
+}
+
+void OneHopCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        invalidations_.fetch_add(shard.entries.size(), std::memory_order_relaxed);
+        shard.lru.clear();
+        shard.entries.clear();
+        shard.by_source.clear();
+        shard.by_dest.clear();
+        shard.by_intermediate.clear();
+    }
+}
+
+OneHopCache::Stats OneHopCache::stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+    }
+    return stats;
+}
+
+void OneHopCache::erase(Shard& shard, std::list<Entry>::iterator it) {
+    int source_id = static_cast<int>(it->key >> 32);
+    int dest_id = static_cast<int>(it->key & 0xFFFFFFFFu);
+    unindex(shard.by_source, source_id, it->key);
+    unindex(shard.by_dest, dest_id, it->key);
+    for (int intermediate : it->intermediates) {
+        unindex(shard.by_intermediate, intermediate, it->key);
+    }
+    shard.entries.erase(it->key);
+    shard.lru.erase(it);
+}
+
+void OneHopCache::collect(const std::unordered_map<int, KeySet>& index, int airport_id,
+                          std::vector<uint64_t>& keys) {
+    auto it = index.find(airport_id);
+    if (it != index.end()) keys.insert(keys.end(), it->second.begin(), it->second.end());
+}
+
+void OneHopCache::erase_keys(Shard& shard, const std::vector<uint64_t>& keys) {
+    for (uint64_t key : keys) {
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) continue;  // Listed under two indexes
+        erase(shard, it->second);
+        invalidations_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
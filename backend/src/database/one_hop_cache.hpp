@@ -0,0 +1,93 @@
+#pragma once
+#include "../models/route.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Structure for one-hop route results
+struct OneHopRoute {
+    Route first_leg;
+    Route second_leg;
+    double total_distance_miles;
+    std::string intermediate_airport_iata;
+};
+
+// Sharded LRU cache of one-hop results keyed by (source, dest) airport id.
+//
+// Results are stored by value, so they outlive the ReadView that built
+// them. Each shard also indexes its entries by source, destination and
+// intermediate airport, which lets a mutation evict exactly the pairs
+// it can affect:
+//  - a route A->B can be the first leg of pairs from A or the second leg
+//    of pairs into B;
+//  - an airport edit can change any result it appears in.
+//
+// Owned by DataStore. Lookups and inserts happen under its shared lock
+// and invalidations under its exclusive lock, so an insert can never race
+// the invalidation of the data it was computed from.
+class OneHopCache {
+public:
+    using Result = std::shared_ptr<const std::vector<OneHopRoute>>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;      // Dropped for capacity
+        uint64_t invalidations = 0;  // Dropped because the data changed
+        size_t entries = 0;
+    };
+
+    explicit OneHopCache(size_t capacity = 16384);
+
+    // nullptr on a miss
+    Result find(int source_id, int dest_id);
+    void insert(int source_id, int dest_id, Result result, const std::vector<int>& intermediates);
+
+    void invalidate_route(int source_id, int dest_id);
+    void invalidate_airport(int airport_id);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct Entry {
+        uint64_t key;
+        Result result;
+        std::vector<int> intermediates;
+    };
+
+    using KeySet = std::unordered_set<uint64_t>;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;
+        std::unordered_map<int, KeySet> by_source, by_dest, by_intermediate;
+    };
+
+    static uint64_t pair_key(int source_id, int dest_id) {
+        return (uint64_t(uint32_t(source_id)) << 32) | uint32_t(dest_id);
+    }
+
+    Shard& shard_for(uint64_t key) { return shards_[(key * 0x9E3779B97F4A7C15ull) >> 60]; }
+
+    // Callers hold the shard's mutex
+    static void erase(Shard& shard, std::list<Entry>::iterator it);
+    static void collect(const std::unordered_map<int, KeySet>& index, int airport_id,
+                        std::vector<uint64_t>& keys);
+    void erase_keys(Shard& shard, const std::vector<uint64_t>& keys);
+
+    size_t shard_capacity_;
+    std::array<Shard, kShards> shards_;
+    std::atomic<uint64_t> hits_{0}, misses_{0}, evictions_{0}, invalidations_{0};
+};
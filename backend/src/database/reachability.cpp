@@ -0,0 +1,303 @@
+#include "reachability.hpp"
+#include <algorithm>
+
+namespace {
+
+// Lower `distance` along `adjacency` starting from `start` at `start_distance`
+// (BFS that only follows improvements). Used both for full landmark BFS and
+// to repair distances after an inserted edge.
+void relax(std::vector<int>& distance, const std::vector<std::vector<int>>& adjacency,
+           int start, int start_distance) {
+    if (distance[start] >= 0 && distance[start] <= start_distance) return;
+    distance[start] = start_distance;
+    std::vector<int> queue{start};
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int v = queue[head];
+        for (int w : adjacency[v]) {
+            if (distance[w] < 0 || distance[w] > distance[v] + 1) {
+                distance[w] = distance[v] + 1;
+                queue.push_back(w);
+            }
+        }
+    }
+}
+
+void erase_one(std::vector<int>& values, int value) {
+    auto it = std::find(values.begin(), values.end(), value);
+    if (it != values.end()) {
+        *it = values.back();
+        values.pop_back();
+    }
+}
+
+} // namespace
+
+void Reachability::build(const std::vector<std::pair<int, int>>& edges) {
+    node_of_.clear();
+    airport_of_.clear();
+    out_.clear();
+    in_.clear();
+    edges_.clear();
+    from_landmark_.clear();
+    to_landmark_.clear();
+
+    // Nodes only; components and closure are computed once at the end
+    auto node = [&](int airport_id) {
+        auto [it, inserted] = node_of_.emplace(airport_id, static_cast<int>(airport_of_.size()));
+        if (inserted) {
+            airport_of_.push_back(airport_id);
+            out_.emplace_back();
+            in_.emplace_back();
+        }
+        return it->second;
+    };
+    for (const auto& [source, dest] : edges) {
+        int a = node(source);
+        int b = node(dest);
+        if (edges_[edge_key(source, dest)]++ == 0) {
+            out_[a].push_back(b);
+            in_[b].push_back(a);
+        }
+    }
+    rebuild();
+    rebuild_landmarks();
+}
+
+void Reachability::add_edge(int source, int dest) {
+    int a = add_node(source);
+    int b = add_node(dest);
+    if (edges_[edge_key(source, dest)]++ > 0) return;  // Parallel route, same graph
+    out_[a].push_back(b);
+    in_[b].push_back(a);
+
+    int ca = component_[a], cb = component_[b];
+    if (ca != cb && !closure_has(ca, cb)) {
+        if (closure_has(cb, ca)) {
+            // The edge closes a cycle: components along it merge
+            rebuild();
+        } else {
+            // Everything that reaches `a` now also reaches whatever `b` reaches
+            const auto reached = closure_[cb];
+            for (auto& bits : closure_) {
+                if (bits[ca / 64] & (uint64_t(1) << (ca % 64))) {
+                    for (size_t w = 0; w < bits.size(); ++w) bits[w] |= reached[w];
+                }
+            }
+        }
+    }
+
+    // Distances only shrink on insert; repair them from the new edge
+    for (size_t k = 0; k < from_landmark_.size(); ++k) {
+        if (from_landmark_[k][a] >= 0) relax(from_landmark_[k], out_, b, from_landmark_[k][a] + 1);
+        if (to_landmark_[k][b] >= 0) relax(to_landmark_[k], in_, a, to_landmark_[k][b] + 1);
+    }
+}
+
+void Reachability::remove_edges(const std::vector<std::pair<int, int>>& edges) {
+    bool split = false, shrunk = false;
+    for (const auto& [source, dest] : edges) {
+        auto it = edges_.find(edge_key(source, dest));
+        if (it == edges_.end() || --it->second > 0) continue;
+        edges_.erase(it);
+
+        int a = node_index(source), b = node_index(dest);
+        erase_one(out_[a], b);
+        erase_one(in_[b], a);
+
+        // Another path from a to b keeps every reachability the edge gave
+        if (path_exists(a, b)) continue;
+        if (component_[a] == component_[b]) {
+            split = true;
+        } else {
+            shrunk = true;
+        }
+    }
+
+    // Landmark distances are left as they are: they may now be too short,
+    // which keeps them valid as lower bounds
+    if (split) {
+        rebuild();
+    } else if (shrunk) {
+        rebuild_closure();
+    }
+}
+
+bool Reachability::reachable(int source, int dest) const {
+    if (source == dest) return true;
+    int a = node_index(source), b = node_index(dest);
+    return a >= 0 && b >= 0 && closure_has(component_[a], component_[b]);
+}
+
+int Reachability::hop_lower_bound(int source, int dest) const {
+    if (source == dest) return 0;
+    int a = node_index(source), b = node_index(dest);
+    if (a < 0 || b < 0 || !closure_has(component_[a], component_[b])) return -1;
+    if (edges_.count(edge_key(source, dest))) return 1;
+
+    // d(a, b) >= d(L, b) - d(L, a) and d(a, b) >= d(a, L) - d(b, L)
+    int bound = 2;
+    for (size_t k = 0; k < from_landmark_.size(); ++k) {
+        const auto& from = from_landmark_[k];
+        const auto& to = to_landmark_[k];
+        if (from[a] >= 0 && from[b] >= 0) bound = std::max(bound, from[b] - from[a]);
+        if (to[a] >= 0 && to[b] >= 0) bound = std::max(bound, to[a] - to[b]);
+    }
+    return bound;
+}
+
+int Reachability::node_index(int airport_id) const {
+    auto it = node_of_.find(airport_id);
+    return it != node_of_.end() ? it->second : -1;
+}
+
+int Reachability::add_node(int airport_id) {
+    auto [it, inserted] = node_of_.emplace(airport_id, static_cast<int>(airport_of_.size()));
+    if (!inserted) return it->second;
+
+    airport_of_.push_back(airport_id);
+    out_.emplace_back();
+    in_.emplace_back();
+    for (auto& distance : from_landmark_) distance.push_back(-1);
+    for (auto& distance : to_landmark_) distance.push_back(-1);
+
+    // New isolated node: its own component, reaching only itself
+    int component = static_cast<int>(closure_.size());
+    component_.push_back(component);
+    size_t words = (closure_.size() + 1 + 63) / 64;
+    for (auto& bits : closure_) bits.resize(words, 0);
+    closure_.emplace_back(words, 0);
+    closure_.back()[component / 64] |= uint64_t(1) << (component % 64);
+    return it->second;
+}
+
+bool Reachability::path_exists(int from, int to) const {
+    std::vector<char> seen(airport_of_.size(), 0);
+    std::vector<int> queue{from};
+    seen[from] = 1;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        for (int w : out_[queue[head]]) {
+            if (w == to) return true;
+            if (!seen[w]) {
+                seen[w] = 1;
+                queue.push_back(w);
+            }
+        }
+    }
+    return false;
+}
+
+bool Reachability::closure_has(int from_component, int to_component) const {
+    return (closure_[from_component][to_component / 64] >> (to_component % 64)) & 1;
+}
+
+void Reachability::rebuild() {
+    // Tarjan's algorithm, iterative to stay clear of deep recursion on
+    // long chains
+    size_t n = airport_of_.size();
+    std::vector<int> index(n, -1), low(n), stack;
+    std::vector<char> on_stack(n, 0);
+    std::vector<std::pair<int, size_t>> calls;  // (node, next out-edge)
+    int counter = 0, components = 0;
+    component_.assign(n, -1);
+
+    for (size_t root = 0; root < n; ++root) {
+        if (index[root] >= 0) continue;
+        auto visit = [&](int v) {
+            index[v] = low[v] = counter++;
+            stack.push_back(v);
+            on_stack[v] = 1;
+            calls.push_back({v, 0});
+        };
+        visit(static_cast<int>(root));
+
+        while (!calls.empty()) {
+            int v = calls.back().first;
+            size_t edge = calls.back().second;
+            if (edge < out_[v].size()) {
+                calls.back().second++;
+                int w = out_[v][edge];
+                if (index[w] < 0) {
+                    visit(w);
+                } else if (on_stack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    on_stack[w] = 0;
+                    component_[w] = components;
+                } while (w != v);
+                components++;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+        }
+    }
+
+    closure_.assign(components, {});
+    rebuild_closure();
+}
+
+void Reachability::rebuild_closure() {
+    // Condensation edges, then closures from the sinks upwards (Kahn's
+    // algorithm on the reversed DAG)
+    size_t components = closure_.size();
+    std::vector<std::vector<int>> successors(components), predecessors(components);
+    for (size_t v = 0; v < out_.size(); ++v) {
+        int cv = component_[v];
+        for (int w : out_[v]) {
+            int cw = component_[w];
+            if (cv == cw) continue;
+            successors[cv].push_back(cw);
+            predecessors[cw].push_back(cv);
+        }
+    }
+
+    size_t words = (components + 63) / 64;
+    std::vector<size_t> pending(components);
+    std::vector<int> ready;
+    for (size_t c = 0; c < components; ++c) {
+        closure_[c].assign(words, 0);
+        closure_[c][c / 64] |= uint64_t(1) << (c % 64);
+        pending[c] = successors[c].size();
+        if (pending[c] == 0) ready.push_back(static_cast<int>(c));
+    }
+
+    for (size_t head = 0; head < ready.size(); ++head) {
+        int c = ready[head];
+        for (int successor : successors[c]) {
+            for (size_t w = 0; w < words; ++w) closure_[c][w] |= closure_[successor][w];
+        }
+        for (int predecessor : predecessors[c]) {
+            if (--pending[predecessor] == 0) ready.push_back(predecessor);
+        }
+    }
+}
+
+void Reachability::rebuild_landmarks() {
+    // The best-connected airports make the tightest landmarks
+    size_t n = airport_of_.size();
+    std::vector<int> nodes(n);
+    for (size_t v = 0; v < n; ++v) nodes[v] = static_cast<int>(v);
+    size_t count = std::min(kLandmarks, n);
+    std::partial_sort(nodes.begin(), nodes.begin() + count, nodes.end(), [&](int a, int b) {
+        size_t degree_a = out_[a].size() + in_[a].size();
+        size_t degree_b = out_[b].size() + in_[b].size();
+        return degree_a != degree_b ? degree_a > degree_b : a < b;
+    });
+
+    from_landmark_.assign(count, std::vector<int>(n, -1));
+    to_landmark_.assign(count, std::vector<int>(n, -1));
+    for (size_t k = 0; k < count; ++k) {
+        relax(from_landmark_[k], out_, nodes[k], 0);
+        relax(to_landmark_[k], in_, nodes[k], 0);
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reachability labeling of the route graph (airports as nodes, distinct
+// nonstop airport pairs as edges), maintained as routes come and go.
+//
+// Strongly connected components are collapsed into a DAG whose transitive
+// closure is stored as one bitset per component, so "can B be reached
+// from A" is two hash lookups and a bit test. Hop lower bounds combine the
+// direct-edge set with BFS distances to and from a few landmark hubs
+// (triangle inequality).
+//
+// Updates:
+//  - Insert: closure bitsets are extended in place; only an insert that
+//    closes a cycle between components recomputes the components.
+//  - Delete: nothing changes while another path still joins the pair.
+//    Otherwise removing the last link between two components recomputes
+//    the closure over the existing DAG, and removing one inside a
+//    component (which may split it) recomputes the components.
+// Landmark distances are repaired on insert. Deletes only lengthen paths,
+// so older distances stay valid lower bounds and are kept until build().
+class Reachability {
+public:
+    void build(const std::vector<std::pair<int, int>>& edges);
+
+    void add_edge(int source, int dest);
+    void remove_edges(const std::vector<std::pair<int, int>>& edges);
+
+    bool reachable(int source, int dest) const;
+
+    // Fewest nonstop legs any itinerary from source to dest can have;
+    // -1 if dest is unreachable
+    int hop_lower_bound(int source, int dest) const;
+
+    size_t component_count() const { return closure_.size(); }
+
+private:
+    static constexpr size_t kLandmarks = 16;
+
+    static uint64_t edge_key(int source, int dest) {
+        return (uint64_t(uint32_t(source)) << 32) | uint32_t(dest);
+    }
+
+    int node_index(int airport_id) const;
+    int add_node(int airport_id);
+    bool path_exists(int from, int to) const;
+    bool closure_has(int from_component, int to_component) const;
+
+    void rebuild();          // Components and closure
+    void rebuild_closure();  // Closure over the current components
+    void rebuild_landmarks();
+
+    // Graph: dense node index per airport, distinct-edge adjacency, and
+    // routes per (source, dest) pair
+    std::unordered_map<int, int> node_of_;
+    std::vector<int> airport_of_;
+    std::vector<std::vector<int>> out_, in_;
+    std::unordered_map<uint64_t, int> edges_;
+
+    // Component per node, and per component a bitset of the components
+    // it reaches (itself included)
+    std::vector<int> component_;
+    std::vector<std::vector<uint64_t>> closure_;
+
+    // Hop distances from / to each landmark, -1 if unreachable
+    std::vector<std::vector<int>> from_landmark_, to_landmark_;
+};
@@ -0,0 +1,177 @@
+#include "roaring_bitmap.hpp"
+#include <algorithm>
+#include <iterator>
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (is_bitmap()) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::add(uint16_t low) {
+    if (is_bitmap()) {
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (!(bits[low >> 6] & bit)) {
+            bits[low >> 6] |= bit;
+            ++cardinality;
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) return;
+    array.insert(it, low);
+    ++cardinality;
+    if (cardinality > kArrayMax) to_bitmap();
+}
+
+void RoaringBitmap::Container::remove(uint16_t low) {
+    if (is_bitmap()) {
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (bits[low >> 6] & bit) {
+            bits[low >> 6] &= ~bit;
+            --cardinality;
+            if (cardinality <= kArrayMax) to_array();
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) {
+        array.erase(it);
+        --cardinality;
+    }
+}
+
+void RoaringBitmap::Container::to_array() {
+    array.clear();
+    array.reserve(cardinality);
+    for (size_t w = 0; w < bits.size(); ++w) {
+        for (uint64_t word = bits[w]; word; word &= word - 1) {
+            array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::to_bitmap() {
+    bits.assign(kBitmapWords, 0);
+    for (uint16_t low : array) {
+        bits[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container out;
+    out.key = a.key;
+
+    if (a.is_bitmap() && b.is_bitmap()) {
+        out.bits.resize(kBitmapWords);
+        for (size_t w = 0; w < kBitmapWords; ++w) {
+            out.bits[w] = a.bits[w] & b.bits[w];
+            out.cardinality += __builtin_popcountll(out.bits[w]);
+        }
+        if (out.cardinality <= kArrayMax) out.to_array();
+        return out;
+    }
+
+    if (a.is_bitmap() || b.is_bitmap()) {
+        const Container& sparse = a.is_bitmap() ? b : a;
+        const Container& dense = a.is_bitmap() ? a : b;
+        for (uint16_t low : sparse.array) {
+            if (dense.contains(low)) out.array.push_back(low);
+        }
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(),
+                              b.array.begin(), b.array.end(),
+                              std::back_inserter(out.array));
+    }
+    out.cardinality = static_cast<uint32_t>(out.array.size());
+    return out;
+}
+
+RoaringBitmap::Container* RoaringBitmap::find(uint16_t key) {
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers_.end() && it->key == key ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find(uint16_t key) const {
+    return const_cast<RoaringBitmap*>(this)->find(key);
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    auto it = std::lower_bound(containers_.begin(), containers_.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers_.end() || it->key != key) {
+        it = containers_.insert(it, Container{});
+        it->key = key;
+    }
+    it->add(static_cast<uint16_t>(value));
+}
+
+void RoaringBitmap::remove(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    if (auto container = find(key)) {
+        container->remove(static_cast<uint16_t>(value));
+        if (container->cardinality == 0) {
+            containers_.erase(containers_.begin() + (container - containers_.data()));
+        }
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    auto container = find(static_cast<uint16_t>(value >> 16));
+    return container && container->contains(static_cast<uint16_t>(value));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& container : containers_) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<Container> result;
+    auto a = containers_.begin();
+    auto b = other.containers_.begin();
+    while (a != containers_.end() && b != other.containers_.end()) {
+        if (a->key < b->key) {
+            ++a;
+        } else if (b->key < a->key) {
+            ++b;
+        } else {
+            Container both = intersect(*a, *b);
+            if (both.cardinality > 0) result.push_back(std::move(both));
+            ++a;
+            ++b;
+        }
+    }
+    containers_ = std::move(result);
+    return *this;
+}
+
+std::vector<uint32_t> RoaringBitmap::to_vector() const {
+    std::vector<uint32_t> values;
+    values.reserve(cardinality());
+    for (const auto& container : containers_) {
+        uint32_t high = uint32_t(container.key) << 16;
+        if (container.is_bitmap()) {
+            for (size_t w = 0; w < container.bits.size(); ++w) {
+                for (uint64_t word = container.bits[w]; word; word &= word - 1) {
+                    values.push_back(high | uint32_t(w * 64 + __builtin_ctzll(word)));
+                }
+            }
+        } else {
+            for (uint16_t low : container.array) {
+                values.push_back(high | low);
+            }
+        }
+    }
+    return values;
+}
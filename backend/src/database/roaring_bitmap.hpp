@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed set of uint32 values in the style of Roaring bitmaps. Values
+// are grouped by their high 16 bits; each group is stored either as a
+// sorted array of low halves (sparse) or as a 65536-bit bitmap (dense),
+// switching at 4096 entries, where both take 8 KiB.
+class RoaringBitmap {
+public:
+    void add(uint32_t value);
+    void remove(uint32_t value);
+    bool contains(uint32_t value) const;
+
+    size_t cardinality() const;
+    bool empty() const { return containers_.empty(); }
+
+    // Intersection; cost depends on the smaller side's containers
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+
+    // Values in ascending order
+    std::vector<uint32_t> to_vector() const;
+
+private:
+    static constexpr size_t kArrayMax = 4096;
+    static constexpr size_t kBitmapWords = 65536 / 64;
+
+    struct Container {
+        uint16_t key;                 // High 16 bits
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;  // Sorted low halves, when sparse
+        std::vector<uint64_t> bits;   // kBitmapWords words, when dense
+
+        bool is_bitmap() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        void remove(uint16_t low);
+        void to_array();
+        void to_bitmap();
+    };
+
+    static Container intersect(const Container& a, const Container& b);
+
+    Container* find(uint16_t key);
+    const Container* find(uint16_t key) const;
+
+    // Sorted by key
+    std::vector<Container> containers_;
+};
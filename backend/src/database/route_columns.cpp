@@ -0,0 +1,222 @@
+#include "route_columns.hpp"
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t kBlock = 64;  // Rows per selection mask word
+
+// Equality bits for one full block of 64 rows
+inline uint64_t eq_block(const int32_t* col, int32_t value) {
+    uint64_t bits = 0;
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi32(value);
+    for (size_t i = 0; i < kBlock; i += 8) {
+        __m256i rows = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + i));
+        __m256i eq = _mm256_cmpeq_epi32(rows, needle);
+        bits |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(eq)))) << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi32(value);
+    for (size_t i = 0; i < kBlock; i += 4) {
+        __m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col + i));
+        __m128i eq = _mm_cmpeq_epi32(rows, needle);
+        bits |= uint64_t(uint32_t(_mm_movemask_ps(_mm_castsi128_ps(eq)))) << i;
+    }
+#else
+    for (size_t i = 0; i < kBlock; ++i) {
+        bits |= uint64_t(col[i] == value) << i;
+    }
+#endif
+    return bits;
+}
+
+// mask &= (col == value), skipping blocks with no surviving rows
+void mask_equal(const std::vector<int32_t>& col, int32_t value, std::vector<uint64_t>& mask) {
+    size_t n = col.size();
+    size_t full_blocks = n / kBlock;
+    for (size_t w = 0; w < full_blocks; ++w) {
+        if (mask[w]) mask[w] &= eq_block(col.data() + w * kBlock, value);
+    }
+    if (full_blocks < mask.size() && mask[full_blocks]) {
+        uint64_t bits = 0;
+        for (size_t i = full_blocks * kBlock; i < n; ++i) {
+            bits |= uint64_t(col[i] == value) << (i - full_blocks * kBlock);
+        }
+        mask[full_blocks] &= bits;
+    }
+}
+
+// Calls fn for each code in a space-separated equipment list
+template <typename Fn>
+void for_each_equipment(const std::string& list, Fn fn) {
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(' ', pos);
+        if (end == std::string::npos) end = list.size();
+        if (end > pos) fn(list.substr(pos, end - pos));
+        pos = end + 1;
+    }
+}
+
+} // namespace
+
+const char* RouteColumns::kernel_name() {
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+void RouteColumns::build(const std::vector<Route>& routes) {
+    airline_id_.clear();
+    source_id_.clear();
+    dest_id_.clear();
+    equipment_dict_.clear();
+    equipment_ids_.clear();
+    equipment_rows_.clear();
+    codeshare_rows_[0] = RoaringBitmap();
+    codeshare_rows_[1] = RoaringBitmap();
+    stops_rows_.clear();
+
+    airline_id_.reserve(routes.size());
+    source_id_.reserve(routes.size());
+    dest_id_.reserve(routes.size());
+    for (const auto& route : routes) {
+        append(route);
+    }
+}
+
+void RouteColumns::append(const Route& route) {
+    auto row = static_cast<uint32_t>(size());
+    airline_id_.push_back(route.airline_id);
+    source_id_.push_back(route.source_airport_id);
+    dest_id_.push_back(route.dest_airport_id);
+    index_row(row, route);
+}
+
+void RouteColumns::update(size_t row, const Route& before, const Route& after) {
+    airline_id_[row] = after.airline_id;
+    source_id_[row] = after.source_airport_id;
+    dest_id_[row] = after.dest_airport_id;
+    unindex_row(static_cast<uint32_t>(row), before);
+    index_row(static_cast<uint32_t>(row), after);
+}
+
+void RouteColumns::swap_remove(size_t row, const Route& removed, const Route& last) {
+    auto last_row = static_cast<uint32_t>(size() - 1);
+    unindex_row(static_cast<uint32_t>(row), removed);
+    if (row != last_row) {
+        unindex_row(last_row, last);
+        airline_id_[row] = airline_id_[last_row];
+        source_id_[row] = source_id_[last_row];
+        dest_id_[row] = dest_id_[last_row];
+        index_row(static_cast<uint32_t>(row), last);
+    }
+    airline_id_.pop_back();
+    source_id_.pop_back();
+    dest_id_.pop_back();
+}
+
+int32_t RouteColumns::equipment_code(const std::string& code) {
+    auto [it, inserted] = equipment_ids_.emplace(code, static_cast<int32_t>(equipment_dict_.size()));
+    if (inserted) {
+        equipment_dict_.push_back(code);
+        equipment_rows_.emplace_back();
+    }
+    return it->second;
+}
+
+void RouteColumns::index_row(uint32_t row, const Route& route) {
+    for_each_equipment(route.equipment, [&](const std::string& code) {
+        equipment_rows_[equipment_code(code)].add(row);
+    });
+    codeshare_rows_[route.codeshare == "Y"].add(row);
+    stops_rows_[route.stops].add(row);
+}
+
+void RouteColumns::unindex_row(uint32_t row, const Route& route) {
+    for_each_equipment(route.equipment, [&](const std::string& code) {
+        auto it = equipment_ids_.find(code);
+        if (it != equipment_ids_.end()) equipment_rows_[it->second].remove(row);
+    });
+    codeshare_rows_[route.codeshare == "Y"].remove(row);
+    auto stops = stops_rows_.find(route.stops);
+    if (stops != stops_rows_.end()) {
+        stops->second.remove(row);
+        if (stops->second.empty()) stops_rows_.erase(stops);
+    }
+}
+
+std::vector<size_t> RouteColumns::filter(const RouteFilter& filter) const {
+    // Bitmap predicates: intersect the posting bitmaps, smallest first
+    std::vector<const RoaringBitmap*> postings;
+    static const RoaringBitmap kNoRows;
+    if (filter.equipment) {
+        auto it = equipment_ids_.find(*filter.equipment);
+        postings.push_back(it != equipment_ids_.end() ? &equipment_rows_[it->second] : &kNoRows);
+    }
+    if (filter.codeshare) {
+        postings.push_back(&codeshare_rows_[*filter.codeshare]);
+    }
+    if (filter.stops) {
+        auto it = stops_rows_.find(*filter.stops);
+        postings.push_back(it != stops_rows_.end() ? &it->second : &kNoRows);
+    }
+
+    bool id_predicates = filter.airline_id || filter.source_airport_id || filter.dest_airport_id;
+    std::vector<size_t> rows;
+
+    if (!postings.empty()) {
+        std::sort(postings.begin(), postings.end(),
+                  [](const RoaringBitmap* a, const RoaringBitmap* b) {
+                      return a->cardinality() < b->cardinality();
+                  });
+        RoaringBitmap candidates = *postings[0];
+        for (size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+            candidates &= *postings[i];
+        }
+
+        // The intersection is usually far smaller than the table, so check
+        // the id columns per candidate rather than scanning them
+        for (uint32_t row : candidates.to_vector()) {
+            if (filter.airline_id && airline_id_[row] != *filter.airline_id) continue;
+            if (filter.source_airport_id && source_id_[row] != *filter.source_airport_id) continue;
+            if (filter.dest_airport_id && dest_id_[row] != *filter.dest_airport_id) continue;
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    size_t n = size();
+    if (!id_predicates) {
+        rows.resize(n);
+        for (size_t i = 0; i < n; ++i) rows[i] = i;
+        return rows;
+    }
+
+    std::vector<uint64_t> mask((n + kBlock - 1) / kBlock, ~uint64_t(0));
+    if (n % kBlock) {
+        mask.back() = (uint64_t(1) << (n % kBlock)) - 1;
+    }
+
+    // Most selective columns first so later passes skip empty blocks
+    if (filter.source_airport_id) mask_equal(source_id_, *filter.source_airport_id, mask);
+    if (filter.dest_airport_id) mask_equal(dest_id_, *filter.dest_airport_id, mask);
+    if (filter.airline_id) mask_equal(airline_id_, *filter.airline_id, mask);
+
+    for (size_t w = 0; w < mask.size(); ++w) {
+        for (uint64_t bits = mask[w]; bits; bits &= bits - 1) {
+            rows.push_back(w * kBlock + __builtin_ctzll(bits));
+        }
+    }
+    return rows;
+}
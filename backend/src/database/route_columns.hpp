@@ -0,0 +1,70 @@
+#pragma once
+#include "../models/route.hpp"
+#include "roaring_bitmap.hpp"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Predicates for GET /api/routes. Unset fields match every route; set
+// fields are ANDed together.
+struct RouteFilter {
+    std::optional<int> airline_id;
+    std::optional<int> source_airport_id;
+    std::optional<int> dest_airport_id;
+    std::optional<int> stops;
+    std::optional<std::string> equipment;  // One aircraft code, e.g. "738"
+    std::optional<bool> codeshare;
+};
+
+// Structure-of-arrays copy of the route table for scans. Row i describes
+// the same route as DataStore::routes_[i].
+//
+// Airline, source and dest are flat int32 columns that the predicate
+// kernels compare 4 (SSE2) or 8 (AVX2) rows at a time. Low-cardinality
+// attributes are kept as inverted indexes instead: one RoaringBitmap of
+// rows per equipment code (parsed out of the space-separated equipment
+// string), per codeshare flag and per stops value, so predicates on them
+// are answered by bitmap intersection.
+class RouteColumns {
+public:
+    void build(const std::vector<Route>& routes);
+
+    // Incremental maintenance. Bulk removals go through build().
+    void append(const Route& route);
+    void update(size_t row, const Route& before, const Route& after);
+
+    // Drop `row` by moving the last row (`last`) into its place, as
+    // DataStore does with routes_
+    void swap_remove(size_t row, const Route& removed, const Route& last);
+
+    // Row indexes of matching routes in table order
+    std::vector<size_t> filter(const RouteFilter& filter) const;
+
+    size_t size() const { return airline_id_.size(); }
+
+    // Distinct equipment codes seen, in first-seen order
+    const std::vector<std::string>& equipment_codes() const { return equipment_dict_; }
+
+    // Name of the predicate kernel compiled in: "avx2", "sse2" or "scalar"
+    static const char* kernel_name();
+
+private:
+    void index_row(uint32_t row, const Route& route);
+    void unindex_row(uint32_t row, const Route& route);
+    int32_t equipment_code(const std::string& code);
+
+    std::vector<int32_t> airline_id_;
+    std::vector<int32_t> source_id_;
+    std::vector<int32_t> dest_id_;
+
+    // Equipment dictionary: code string <-> dense id, id -> rows
+    std::vector<std::string> equipment_dict_;
+    std::unordered_map<std::string, int32_t> equipment_ids_;
+    std::vector<RoaringBitmap> equipment_rows_;
+
+    RoaringBitmap codeshare_rows_[2];  // [0] = not codeshare, [1] = codeshare
+    std::map<int, RoaringBitmap> stops_rows_;
+};
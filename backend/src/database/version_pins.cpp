@@ -0,0 +1,97 @@
+#include "version_pins.hpp"
+#include <set>
+
+VersionPins::Snapshot VersionPins::find(uint64_t version) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked();
+    auto it = versions_.find(version);
+    return it == versions_.end() ? nullptr : it->second.lock();
+}
+
+std::optional<VersionPins::Pin> VersionPins::add(uint64_t generation, uint64_t version, Snapshot snapshot,
+                                                 std::chrono::seconds ttl) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked();
+    if (generation != generation_) return std::nullopt;
+
+    // Two pins racing on one version share whichever copy was first
+    auto it = versions_.find(version);
+    if (it != versions_.end()) {
+        if (auto existing = it->second.lock()) snapshot = std::move(existing);
+    }
+    bool new_version = true;
+    for (const auto& [id, entry] : pins_) {
+        if (entry.version == version) new_version = false;
+    }
+    if (new_version && pinned_versions_locked() >= kMaxVersions) return std::nullopt;
+
+    versions_[version] = snapshot;
+    Pin pin{next_id_++, version, Clock::now() + ttl};
+    pins_[pin.id] = Entry{version, std::move(snapshot), pin.expires};
+    return pin;
+}
+
+bool VersionPins::remove(uint64_t pin_id) {
+    Snapshot released;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pins_.find(pin_id);
+    if (it == pins_.end()) return false;
+    // Freed (if this was the last holder) after the lock is dropped
+    released = std::move(it->second.snapshot);
+    pins_.erase(it);
+    expire_locked();
+    return true;
+}
+
+VersionPins::Snapshot VersionPins::share(uint64_t generation, uint64_t version, Snapshot snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked();
+    if (generation != generation_) return snapshot;
+    auto it = versions_.find(version);
+    if (it != versions_.end()) {
+        if (auto existing = it->second.lock()) return existing;
+    }
+    versions_[version] = snapshot;
+    return snapshot;
+}
+
+void VersionPins::reset(uint64_t generation) {
+    std::map<uint64_t, Entry> released;
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_ = generation;
+    // Copies are freed after the lock is dropped, unless a reader holds one
+    released.swap(pins_);
+    versions_.clear();
+}
+
+std::vector<VersionPins::Pin> VersionPins::pins() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked();
+    std::vector<Pin> result;
+    for (const auto& [id, entry] : pins_) {
+        result.push_back(Pin{id, entry.version, entry.expires});
+    }
+    return result;
+}
+
+size_t VersionPins::retained_versions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked();
+    return versions_.size();
+}
+
+void VersionPins::expire_locked() {
+    auto now = Clock::now();
+    for (auto it = pins_.begin(); it != pins_.end();) {
+        it = it->second.expires <= now ? pins_.erase(it) : std::next(it);
+    }
+    for (auto it = versions_.begin(); it != versions_.end();) {
+        it = it->second.expired() ? versions_.erase(it) : std::next(it);
+    }
+}
+
+size_t VersionPins::pinned_versions_locked() const {
+    std::set<uint64_t> versions;
+    for (const auto& [id, entry] : pins_) versions.insert(entry.version);
+    return versions.size();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+class DataStore;
+
+// Old versions of a DataStore kept readable for as-of queries.
+//
+// Every committed mutation is a new version, numbered by its change-log
+// sequence. Pinning freezes a read-only copy of the store at the current
+// version; reports that must agree with each other then all read that
+// copy while writers carry on. A copy is shared by every pin on its
+// version and freed once its last pin is released or expires and no
+// reader still holds it.
+//
+// Owned by DataStore; see DataStore::pin() and DataStore::read_at().
+class VersionPins {
+public:
+    using Snapshot = std::shared_ptr<const DataStore>;
+    using Clock = std::chrono::steady_clock;
+
+    struct Pin {
+        uint64_t id;
+        uint64_t version;
+        Clock::time_point expires;
+    };
+
+    static constexpr size_t kMaxVersions = 8;
+
+    // Copy already held for `version`, or null
+    Snapshot find(uint64_t version);
+
+    // Pins `snapshot` (at `version` of change-log `generation`) until `ttl`
+    // passes. If a copy of that version is already held it is shared
+    // instead. Nullopt when kMaxVersions other versions are pinned, or when
+    // `generation` is no longer current.
+    std::optional<Pin> add(uint64_t generation, uint64_t version, Snapshot snapshot,
+                           std::chrono::seconds ttl);
+
+    // Keep track of `snapshot` (at `version` of `generation`) while anyone
+    // holds it, without pinning it. Returns the copy already held for that
+    // version if there is one. Not tracked if `generation` is no longer
+    // current.
+    Snapshot share(uint64_t generation, uint64_t version, Snapshot snapshot);
+
+    // Drop every pin and copy: the change log was reset to `generation`
+    // and its version numbers may now name other data
+    void reset(uint64_t generation);
+
+    bool remove(uint64_t pin_id);
+    std::vector<Pin> pins();
+
+    // Versions still in memory, pinned or held by a reader
+    size_t retained_versions();
+
+private:
+    struct Entry {
+        uint64_t version;
+        Snapshot snapshot;
+        Clock::time_point expires;
+    };
+
+    // Callers hold mutex_
+    void expire_locked();
+    size_t pinned_versions_locked() const;
+
+    std::mutex mutex_;
+    uint64_t generation_ = 0;
+    uint64_t next_id_ = 1;
+    std::map<uint64_t, Entry> pins_;                                // Pin id -> pin
+    std::map<uint64_t, std::weak_ptr<const DataStore>> versions_;   // Every copy still alive
+};
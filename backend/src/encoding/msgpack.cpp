@@ -0,0 +1,442 @@
+#include "msgpack.hpp"
+#include "../utils/string_utils.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <vector>
+
+namespace msgpack {
+
+namespace {
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool is_msgpack_type(std::string_view type) {
+    return type == "application/msgpack" || type == "application/x-msgpack" ||
+           type == "application/vnd.msgpack";
+}
+
+bool is_json_type(std::string_view type) {
+    return type == "application/json" || type == "application/*" || type == "*/*";
+}
+
+// Element counts come first in MessagePack, so the transcoder scans the
+// document once to count each container's elements (in opening order),
+// then emits it in a second pass
+class JsonTranscoder {
+public:
+    JsonTranscoder(std::string_view json, Writer& out) : s_(json), out_(out) {}
+
+    bool run() {
+        if (!count_containers()) return false;
+        pos_ = 0;
+        if (!value()) return false;
+        skip_ws();
+        return pos_ == s_.size();
+    }
+
+private:
+    void skip_ws() {
+        while (pos_ < s_.size() && (s_[pos_] == ' ' || s_[pos_] == '\n' || s_[pos_] == '\r' || s_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    // Skips a string literal starting at pos_ (the opening quote)
+    bool skip_string() {
+        for (++pos_; pos_ < s_.size(); ++pos_) {
+            if (s_[pos_] == '\\') {
+                ++pos_;
+            } else if (s_[pos_] == '"') {
+                ++pos_;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool count_containers() {
+        std::vector<size_t> open;
+        while (pos_ < s_.size()) {
+            char c = s_[pos_];
+            if (c == '"') {
+                if (!skip_string()) return false;
+                continue;
+            }
+            ++pos_;
+            if (c == '{' || c == '[') {
+                open.push_back(counts_.size());
+                skip_ws();
+                bool empty = pos_ < s_.size() && (s_[pos_] == '}' || s_[pos_] == ']');
+                counts_.push_back(empty ? 0 : 1);
+            } else if (c == ',') {
+                if (open.empty()) return false;
+                ++counts_[open.back()];
+            } else if (c == '}' || c == ']') {
+                if (open.empty()) return false;
+                open.pop_back();
+            }
+        }
+        return open.empty();
+    }
+
+    bool value() {
+        skip_ws();
+        if (pos_ >= s_.size()) return false;
+        switch (s_[pos_]) {
+            case '{': return object();
+            case '[': return list();
+            case '"': {
+                std::string_view text;
+                if (!string(text)) return false;
+                out_.string(text);
+                return true;
+            }
+            case 't': return literal("true", [this] { out_.boolean(true); });
+            case 'f': return literal("false", [this] { out_.boolean(false); });
+            case 'n': return literal("null", [this] { out_.nil(); });
+            default: return number();
+        }
+    }
+
+    template <typename Emit>
+    bool literal(std::string_view word, Emit emit) {
+        if (s_.substr(pos_, word.size()) != word) return false;
+        pos_ += word.size();
+        emit();
+        return true;
+    }
+
+    bool object() {
+        ++pos_;
+        size_t count = counts_[next_container_++];
+        out_.map(static_cast<uint32_t>(count));
+        for (size_t i = 0; i < count; ++i) {
+            skip_ws();
+            std::string_view key;
+            if (pos_ >= s_.size() || s_[pos_] != '"' || !string(key)) return false;
+            out_.string(key);
+            skip_ws();
+            if (pos_ >= s_.size() || s_[pos_++] != ':') return false;
+            if (!value()) return false;
+            skip_ws();
+            if (i + 1 < count && (pos_ >= s_.size() || s_[pos_++] != ',')) return false;
+        }
+        skip_ws();
+        return pos_ < s_.size() && s_[pos_++] == '}';
+    }
+
+    bool list() {
+        ++pos_;
+        size_t count = counts_[next_container_++];
+        out_.array(static_cast<uint32_t>(count));
+        for (size_t i = 0; i < count; ++i) {
+            if (!value()) return false;
+            skip_ws();
+            if (i + 1 < count && (pos_ >= s_.size() || s_[pos_++] != ',')) return false;
+        }
+        skip_ws();
+        return pos_ < s_.size() && s_[pos_++] == ']';
+    }
+
+    static void append_utf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xc0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xe0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+    bool hex4(uint32_t& cp) {
+        if (pos_ + 4 > s_.size()) return false;
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = s_[pos_++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    // Parses the string literal at pos_; `text` views the input when the
+    // literal has no escapes, otherwise a scratch buffer valid until the
+    // next call
+    bool string(std::string_view& text) {
+        size_t start = ++pos_;
+        while (pos_ < s_.size() && s_[pos_] != '"' && s_[pos_] != '\\') ++pos_;
+        if (pos_ >= s_.size()) return false;
+        if (s_[pos_] == '"') {
+            text = s_.substr(start, pos_++ - start);
+            return true;
+        }
+
+        scratch_.assign(s_.data() + start, pos_ - start);
+        if (!unescape(scratch_)) return false;
+        text = scratch_;
+        return true;
+    }
+
+    // Decodes the rest of a string literal with escapes, from pos_ up to
+    // and including the closing quote, onto `text`
+    bool unescape(std::string& text) {
+        while (pos_ < s_.size()) {
+            char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                text += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) return false;
+            char escape = s_[pos_++];
+            switch (escape) {
+                case '"': case '\\': case '/': text += escape; break;
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'n': text += '\n'; break;
+                case 'r': text += '\r'; break;
+                case 't': text += '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!hex4(cp)) return false;
+                    // Surrogate pair
+                    if (cp >= 0xd800 && cp < 0xdc00 && s_.substr(pos_, 2) == "\\u") {
+                        pos_ += 2;
+                        uint32_t low;
+                        if (!hex4(low)) return false;
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(text, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool number() {
+        size_t start = pos_;
+        bool real = false;
+        while (pos_ < s_.size()) {
+            char c = s_[pos_];
+            if (c == '.' || c == 'e' || c == 'E') real = true;
+            else if (!(c == '-' || c == '+' || (c >= '0' && c <= '9'))) break;
+            ++pos_;
+        }
+        if (pos_ == start) return false;
+
+        std::string token(s_.substr(start, pos_ - start));
+        char* end = nullptr;
+        errno = 0;
+        // Integers that overflow 64 bits fall back to a real
+        if (!real && token[0] == '-') {
+            long long v = std::strtoll(token.c_str(), &end, 10);
+            if (*end == '\0' && errno == 0) {
+                out_.integer(v);
+                return true;
+            }
+        } else if (!real) {
+            unsigned long long v = std::strtoull(token.c_str(), &end, 10);
+            if (*end == '\0' && errno == 0) {
+                out_.uinteger(v);
+                return true;
+            }
+        }
+        double v = std::strtod(token.c_str(), &end);
+        if (*end != '\0') return false;
+        out_.real(v);
+        return true;
+    }
+
+    std::string_view s_;
+    Writer& out_;
+    size_t pos_ = 0;
+    std::vector<size_t> counts_;
+    size_t next_container_ = 0;
+    std::string scratch_;
+};
+
+} // namespace
+
+Format negotiate(const std::string& accept) {
+    double json_q = accept.empty() ? 1.0 : 0.0;
+    double msgpack_q = 0.0;
+    bool columns = false;
+
+    std::string_view rest(accept);
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view range = rest.substr(0, comma);
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+        size_t semi = range.find(';');
+        std::string type = utils::to_lower(std::string(trim(range.substr(0, semi))));
+        double q = 1.0;
+        bool layout_columns = false;
+        while (semi != std::string_view::npos) {
+            range = range.substr(semi + 1);
+            semi = range.find(';');
+            std::string param = utils::to_lower(std::string(trim(range.substr(0, semi))));
+            if (param.compare(0, 2, "q=") == 0) q = std::atof(param.c_str() + 2);
+            if (param == "layout=columns") layout_columns = true;
+        }
+
+        if (is_msgpack_type(type) && q > msgpack_q) {
+            msgpack_q = q;
+            columns = layout_columns;
+        } else if (is_json_type(type) && q > json_q) {
+            json_q = q;
+        }
+    }
+
+    if (msgpack_q <= 0.0 || msgpack_q < json_q) return Format::Json;
+    return columns ? Format::Columns : Format::Rows;
+}
+
+void Writer::map(uint32_t size) {
+    if (size < 16) {
+        out_ += static_cast<char>(0x80 | size);
+    } else if (size <= 0xffff) {
+        out_ += '\xde';
+        put_be(size, 2);
+    } else {
+        out_ += '\xdf';
+        put_be(size, 4);
+    }
+}
+
+void Writer::array(uint32_t size) {
+    if (size < 16) {
+        out_ += static_cast<char>(0x90 | size);
+    } else if (size <= 0xffff) {
+        out_ += '\xdc';
+        put_be(size, 2);
+    } else {
+        out_ += '\xdd';
+        put_be(size, 4);
+    }
+}
+
+void Writer::integer(int64_t value) {
+    if (value >= 0) {
+        uinteger(static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+        out_ += static_cast<char>(value);
+    } else if (value >= INT8_MIN) {
+        out_ += '\xd0';
+        put_be(static_cast<uint64_t>(value), 1);
+    } else if (value >= INT16_MIN) {
+        out_ += '\xd1';
+        put_be(static_cast<uint64_t>(value), 2);
+    } else if (value >= INT32_MIN) {
+        out_ += '\xd2';
+        put_be(static_cast<uint64_t>(value), 4);
+    } else {
+        out_ += '\xd3';
+        put_be(static_cast<uint64_t>(value), 8);
+    }
+}
+
+void Writer::uinteger(uint64_t value) {
+    if (value < 0x80) {
+        out_ += static_cast<char>(value);
+    } else if (value <= 0xff) {
+        out_ += '\xcc';
+        put_be(value, 1);
+    } else if (value <= 0xffff) {
+        out_ += '\xcd';
+        put_be(value, 2);
+    } else if (value <= 0xffffffff) {
+        out_ += '\xce';
+        put_be(value, 4);
+    } else {
+        out_ += '\xcf';
+        put_be(value, 8);
+    }
+}
+
+void Writer::real(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    out_ += '\xcb';
+    put_be(bits, 8);
+}
+
+void Writer::string(std::string_view value) {
+    size_t size = value.size();
+    if (size < 32) {
+        out_ += static_cast<char>(0xa0 | size);
+    } else if (size <= 0xff) {
+        out_ += '\xd9';
+        put_be(size, 1);
+    } else if (size <= 0xffff) {
+        out_ += '\xda';
+        put_be(size, 2);
+    } else {
+        out_ += '\xdb';
+        put_be(size, 4);
+    }
+    out_.append(value.data(), size);
+}
+
+void Writer::bin(const void* data, size_t size) {
+    bin_header(size);
+    out_.append(static_cast<const char*>(data), size);
+}
+
+void Writer::bin_header(size_t size) {
+    if (size <= 0xff) {
+        out_ += '\xc4';
+        put_be(size, 1);
+    } else if (size <= 0xffff) {
+        out_ += '\xc5';
+        put_be(size, 2);
+    } else {
+        out_ += '\xc6';
+        put_be(size, 4);
+    }
+}
+
+void Writer::put_be(uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        out_ += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+void Writer::store_le(char* dst, const unsigned char* native, size_t size) {
+    static const bool little_endian = [] {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }();
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = static_cast<char>(native[little_endian ? i : size - 1 - i]);
+    }
+}
+
+bool from_json(std::string_view json, std::string& out) {
+    Writer writer;
+    writer.reserve(json.size());
+    if (!JsonTranscoder(json, writer).run()) return false;
+    out = writer.take();
+    return true;
+}
+
+} // namespace msgpack
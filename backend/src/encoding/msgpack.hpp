@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// MessagePack responses, for service-to-service callers that would rather
+// not parse JSON. Requested with `Accept: application/msgpack` (also
+// application/x-msgpack, application/vnd.msgpack); documents have the same
+// keys and nesting as their JSON form.
+//
+// List endpoints also offer a columnar layout, `Accept: application/msgpack;
+// layout=columns`: the list becomes a map from field name to a column of
+// values. Integer columns are bin objects of little-endian int32 and real
+// columns bin objects of little-endian float64, so a client can copy them
+// straight into typed arrays; string columns are arrays of str.
+namespace msgpack {
+
+constexpr const char* kContentType = "application/msgpack";
+
+enum class Format { Json, Rows, Columns };
+
+// Best format `accept` allows; JSON unless MessagePack is listed with a
+// quality at least as high
+Format negotiate(const std::string& accept);
+
+// Appends MessagePack values to a byte buffer. Containers are written as a
+// header with the element count followed by the elements.
+class Writer {
+public:
+    void reserve(size_t bytes) { out_.reserve(bytes); }
+
+    void map(uint32_t size);
+    void array(uint32_t size);
+    void nil() { out_ += '\xc0'; }
+    void boolean(bool value) { out_ += value ? '\xc3' : '\xc2'; }
+    void integer(int64_t value);
+    void uinteger(uint64_t value);
+    void real(double value);
+    void string(std::string_view value);
+    void bin(const void* data, size_t size);
+
+    // Fixed-width little-endian column as one bin object; `get(i)` returns
+    // element i, converted to T
+    template <typename T, typename Get>
+    void column(size_t count, Get get) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8, "columns hold 32- or 64-bit values");
+        bin_header(count * sizeof(T));
+        size_t at = out_.size();
+        out_.resize(at + count * sizeof(T));
+        for (size_t i = 0; i < count; ++i, at += sizeof(T)) {
+            T value = get(i);
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            store_le(&out_[at], bytes, sizeof(T));
+        }
+    }
+
+    // Column of strings as an array of str
+    template <typename Get>
+    void strings(size_t count, Get get) {
+        array(static_cast<uint32_t>(count));
+        for (size_t i = 0; i < count; ++i) string(get(i));
+    }
+
+    const std::string& data() const { return out_; }
+    std::string take() { return std::move(out_); }
+
+private:
+    void bin_header(size_t size);
+    void put_be(uint64_t value, int bytes);
+    static void store_le(char* dst, const unsigned char* native, size_t size);
+
+    std::string out_;
+};
+
+// Writes a list of models (anything with to_msgpack() and a static
+// to_msgpack_columns()) as an array of maps, or as a map of columns
+template <typename T>
+void write_list(Writer& out, const std::vector<const T*>& items, Format format) {
+    if (format == Format::Columns) {
+        T::to_msgpack_columns(items, out);
+        return;
+    }
+    out.array(static_cast<uint32_t>(items.size()));
+    for (const T* item : items) item->to_msgpack(out);
+}
+
+// Re-encodes a JSON document as MessagePack, keeping key order; false if
+// `json` is not valid JSON. Used for responses without a native encoder.
+bool from_json(std::string_view json, std::string& out);
+
+} // namespace msgpack
@@ -0,0 +1,21 @@
+#include "msgpack_middleware.hpp"
+#include "../metrics/metrics.hpp"
+
+void MsgpackMiddleware::before_handle(crow::request& req, crow::response& /*res*/, context& ctx) {
+    ctx.format = msgpack::negotiate(req.get_header_value("Accept"));
+}
+
+void MsgpackMiddleware::after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+    res.add_header("Vary", "Accept");
+    if (ctx.format == msgpack::Format::Json || res.body.empty()) return;
+    if (res.get_header_value("Content-Type").compare(0, 16, "application/json") != 0) return;
+    if (!res.get_header_value("Content-Encoding").empty()) return;
+
+    static const auto transcoded = metrics::counter(
+        "flight_msgpack_transcoded_total", "", "JSON responses re-encoded as MessagePack");
+    std::string packed;
+    if (!msgpack::from_json(res.body, packed)) return;
+    transcoded.inc();
+    res.body = std::move(packed);
+    res.set_header("Content-Type", msgpack::kContentType);
+}
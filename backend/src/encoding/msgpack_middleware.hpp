@@ -0,0 +1,18 @@
+#pragma once
+#include "crow.h"
+#include "msgpack.hpp"
+
+// Serves MessagePack to clients that ask for it (see msgpack.hpp). Handlers
+// with a native encoder set the msgpack Content-Type themselves and are
+// passed through; any other JSON response is re-encoded here.
+//
+// Registered after CompressionMiddleware so the body is re-encoded before
+// it is compressed.
+struct MsgpackMiddleware {
+    struct context {
+        msgpack::Format format = msgpack::Format::Json;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
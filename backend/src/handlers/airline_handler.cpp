@@ -1,57 +1,168 @@
 #include "airline_handler.hpp"
+#include "query_offload.hpp"
+#include "version_handler.hpp"
+#include "../compression/precompressed_response.hpp"
+#include "../encoding/msgpack.hpp"
+#include "../metrics/request_trace.hpp"
 
-void AirlineHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStore& store) {
+using trace::Phase;
+using trace::ScopedPhase;
+
+void AirlineHandler::register_routes(FlightApp& app, DataStore& store) {
     // 1.1 Get airline by IATA
     CROW_ROUTE(app, "/api/airlines/<string>")
-    ([&store](const std::string& iata) {
-        auto airline = store.get_airline_by_iata(iata);
-        if (airline) {
-            return crow::response(200, airline->to_json());
+    ([&store](const crow::request& req, const std::string& iata) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airline* airline;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airline = view->airline_by_iata(iata);
         }
-        return crow::response(404, "Airline not found");
+        if (!airline) {
+            return crow::response(404, "Airline not found");
+        }
+
+        crow::json::wvalue json;
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json = airline->to_json();
+        }
+        ScopedPhase phase(Phase::Serialize);
+        return crow::response(200, json);
+    });
+
+    // 1.1 Get airline by ICAO
+    CROW_ROUTE(app, "/api/airlines/icao/<string>")
+    ([&store](const crow::request& req, const std::string& icao) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airline* airline;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airline = view->airline_by_icao(icao);
+        }
+        if (!airline) {
+            return crow::response(404, "Airline not found");
+        }
+
+        crow::json::wvalue json;
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json = airline->to_json();
+        }
+        ScopedPhase phase(Phase::Serialize);
+        return crow::response(200, json);
     });
 
     // 2.1a Get airports by airline routes
     CROW_ROUTE(app, "/api/airlines/<string>/airports")
-    ([&store](const std::string& iata) {
-        auto results = store.get_airports_by_airline_routes(iata);
-        
-        auto airline = store.get_airline_by_iata(iata);
+    ([&store](const crow::request& req, const std::string& iata) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airline* airline;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airline = view->airline_by_iata(iata);
+        }
         if (!airline) {
             return crow::response(404, "Airline not found");
         }
 
+        std::vector<AirportRouteRef> results;
+        {
+            ScopedPhase phase(Phase::Query);
+            results = view->airports_by_airline_routes(*airline);
+        }
+
         crow::json::wvalue json;
-        json["airline_name"] = airline->name;
-        json["airline_iata"] = airline->iata;
-        
-        std::vector<crow::json::wvalue> airports_json;
-        for (const auto& result : results) {
-            crow::json::wvalue item;
-            item["airport"] = result.airport.to_json();
-            item["route_count"] = result.route_count;
-            airports_json.push_back(std::move(item));
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json["airline_name"] = airline->name;
+            json["airline_iata"] = airline->iata;
+
+            std::vector<crow::json::wvalue> airports_json;
+            for (const auto& result : results) {
+                crow::json::wvalue item;
+                item["airport"] = result.airport->to_json();
+                item["route_count"] = result.route_count;
+                airports_json.push_back(std::move(item));
+            }
+            json["airports"] = std::move(airports_json);
+            json["total_airports"] = results.size();
         }
-        json["airports"] = std::move(airports_json);
-        json["total_airports"] = results.size();
 
+        ScopedPhase phase(Phase::Serialize);
         return crow::response(200, json);
     });
 
-    // 2.2a Get all airlines sorted by IATA
+    // 2.2a Get all airlines sorted by IATA (offloaded: serializes every airline)
+    // The body only changes with the data version, so it is built and
+    // compressed once per version and then served from memory, separately
+    // for JSON and each MessagePack layout
     CROW_ROUTE(app, "/api/airlines")
-    ([&store]() {
-        auto airlines = store.get_all_airlines_sorted_by_iata();
-        
-        crow::json::wvalue json;
-        std::vector<crow::json::wvalue> airlines_json;
-        for (const auto& airline : airlines) {
-            airlines_json.push_back(airline.to_json());
-        }
-        json["airlines"] = std::move(airlines_json);
-        json["total"] = airlines.size();
+    ([&store](const crow::request& req, crow::response& res) {
+        std::string accept_encoding = req.get_header_value("Accept-Encoding");
+        msgpack::Format format = msgpack::negotiate(req.get_header_value("Accept"));
+        offload::run(req, res, [&store, accept_encoding, format, params = req.url_params](
+                                   const utils::Deadline& deadline) {
+            static PrecompressedResponse cached_body;
+            static PrecompressedResponse cached_rows(msgpack::kContentType);
+            static PrecompressedResponse cached_columns(msgpack::kContentType);
+            crow::response error;
+            auto view = VersionHandler::read(store, params, error);
+            if (!view) return error;
+            if (format != msgpack::Format::Json) {
+                auto& cached = format == msgpack::Format::Rows ? cached_rows : cached_columns;
+                return cached.serve(accept_encoding, view->generation(), view->version(), deadline, [&] {
+                    std::vector<const Airline*> airlines;
+                    {
+                        ScopedPhase phase(Phase::Query);
+                        airlines = view->airlines_sorted_by_iata();
+                    }
 
-        return crow::response(200, json);
+                    ScopedPhase phase(Phase::Serialize);
+                    bool columns = format == msgpack::Format::Columns;
+                    msgpack::Writer out;
+                    out.reserve(airlines.size() * 128);
+                    out.map(columns ? 3 : 2);
+                    out.string("airlines");
+                    msgpack::write_list(out, airlines, format);
+                    out.string("total");
+                    out.uinteger(airlines.size());
+                    if (columns) {
+                        out.string("layout");
+                        out.string("columns");
+                    }
+                    return out.take();
+                });
+            }
+            return cached_body.serve(accept_encoding, view->generation(), view->version(), deadline, [&] {
+                std::vector<const Airline*> airlines;
+                {
+                    ScopedPhase phase(Phase::Query);
+                    airlines = view->airlines_sorted_by_iata();
+                }
+
+                crow::json::wvalue json;
+                {
+                    ScopedPhase phase(Phase::JsonBuild);
+                    std::vector<crow::json::wvalue> airlines_json;
+                    for (auto airline : airlines) {
+                        if (deadline.expired()) break;
+                        airlines_json.push_back(airline->to_json());
+                    }
+                    json["airlines"] = std::move(airlines_json);
+                    json["total"] = airlines.size();
+                }
+
+                ScopedPhase phase(Phase::Serialize);
+                return json.dump();
+            });
+        });
     });
 
     // 3. Insert airline
@@ -62,15 +173,7 @@ void AirlineHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStor
             return crow::response(400, "Invalid JSON");
         }
 
-        Airline airline;
-        airline.id = body["id"].i();
-        airline.name = body["name"].s();
-        airline.alias = body.has("alias") ? std::string(body["alias"].s()) : "";
-        airline.iata = body["iata"].s();
-        airline.icao = body.has("icao") ? std::string(body["icao"].s()) : "";
-        airline.callsign = body.has("callsign") ? std::string(body["callsign"].s()) : "";
-        airline.country = body.has("country") ? std::string(body["country"].s()) : "";
-        airline.active = body.has("active") ? std::string(body["active"].s()) : "Y";
+        Airline airline = Airline::from_json(body);
 
         if (store.insert_airline(airline)) {
             return crow::response(201, airline.to_json());
@@ -1,57 +1,188 @@
 #include "airport_handler.hpp"
+#include "query_offload.hpp"
+#include "version_handler.hpp"
+#include "../compression/precompressed_response.hpp"
+#include "../encoding/msgpack.hpp"
+#include "../metrics/request_trace.hpp"
 
-void AirportHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStore& store) {
+using trace::Phase;
+using trace::ScopedPhase;
+
+namespace {
+
+// Attach the latest background centrality result, if there is one
+void add_centrality(crow::json::wvalue& json, const DataStore::ReadView& view, int airport_id) {
+    auto scores = view.centrality();
+    if (!scores) return;
+    auto it = scores->airports.find(airport_id);
+    if (it == scores->airports.end()) return;
+
+    json["centrality"]["pagerank"] = it->second.pagerank;
+    json["centrality"]["pagerank_rank"] = it->second.pagerank_rank;
+    json["centrality"]["betweenness"] = it->second.betweenness;
+    json["centrality"]["betweenness_rank"] = it->second.betweenness_rank;
+    json["centrality"]["version"] = scores->version;
+}
+
+} // namespace
+
+void AirportHandler::register_routes(FlightApp& app, DataStore& store) {
     // 1.2 Get airport by IATA
     CROW_ROUTE(app, "/api/airports/<string>")
-    ([&store](const std::string& iata) {
-        auto airport = store.get_airport_by_iata(iata);
-        if (airport) {
-            return crow::response(200, airport->to_json());
+    ([&store](const crow::request& req, const std::string& iata) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airport* airport;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airport = view->airport_by_iata(iata);
         }
-        return crow::response(404, "Airport not found");
+        if (!airport) {
+            return crow::response(404, "Airport not found");
+        }
+
+        crow::json::wvalue json;
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json = airport->to_json();
+            add_centrality(json, *view, airport->id);
+        }
+        ScopedPhase phase(Phase::Serialize);
+        return crow::response(200, json);
+    });
+
+    // 1.2 Get airport by ICAO
+    CROW_ROUTE(app, "/api/airports/icao/<string>")
+    ([&store](const crow::request& req, const std::string& icao) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airport* airport;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airport = view->airport_by_icao(icao);
+        }
+        if (!airport) {
+            return crow::response(404, "Airport not found");
+        }
+
+        crow::json::wvalue json;
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json = airport->to_json();
+            add_centrality(json, *view, airport->id);
+        }
+        ScopedPhase phase(Phase::Serialize);
+        return crow::response(200, json);
     });
 
     // 2.1b Get airlines by airport routes
     CROW_ROUTE(app, "/api/airports/<string>/airlines")
-    ([&store](const std::string& iata) {
-        auto results = store.get_airlines_by_airport_routes(iata);
-        
-        auto airport = store.get_airport_by_iata(iata);
+    ([&store](const crow::request& req, const std::string& iata) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airport* airport;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            airport = view->airport_by_iata(iata);
+        }
         if (!airport) {
             return crow::response(404, "Airport not found");
         }
 
+        std::vector<AirlineRouteRef> results;
+        {
+            ScopedPhase phase(Phase::Query);
+            results = view->airlines_by_airport_routes(*airport);
+        }
+
         crow::json::wvalue json;
-        json["airport_name"] = airport->name;
-        json["airport_iata"] = airport->iata;
-        
-        std::vector<crow::json::wvalue> airlines_json;
-        for (const auto& result : results) {
-            crow::json::wvalue item;
-            item["airline"] = result.airline.to_json();
-            item["route_count"] = result.route_count;
-            airlines_json.push_back(std::move(item));
-        }
-        json["airlines"] = std::move(airlines_json);
-        json["total_airlines"] = results.size();
+        {
+            ScopedPhase phase(Phase::JsonBuild);
+            json["airport_name"] = airport->name;
+            json["airport_iata"] = airport->iata;
+
+            std::vector<crow::json::wvalue> airlines_json;
+            for (const auto& result : results) {
+                crow::json::wvalue item;
+                item["airline"] = result.airline->to_json();
+                item["route_count"] = result.route_count;
+                airlines_json.push_back(std::move(item));
+            }
+            json["airlines"] = std::move(airlines_json);
+            json["total_airlines"] = results.size();
+        }
 
+        ScopedPhase phase(Phase::Serialize);
         return crow::response(200, json);
     });
 
-    // 2.2b Get all airports sorted by IATA
+    // 2.2b Get all airports sorted by IATA (offloaded: serializes every airport)
+    // The body only changes with the data version, so it is built and
+    // compressed once per version and then served from memory, separately
+    // for JSON and each MessagePack layout
     CROW_ROUTE(app, "/api/airports")
-    ([&store]() {
-        auto airports = store.get_all_airports_sorted_by_iata();
-        
-        crow::json::wvalue json;
-        std::vector<crow::json::wvalue> airports_json;
-        for (const auto& airport : airports) {
-            airports_json.push_back(airport.to_json());
-        }
-        json["airports"] = std::move(airports_json);
-        json["total"] = airports.size();
+    ([&store](const crow::request& req, crow::response& res) {
+        std::string accept_encoding = req.get_header_value("Accept-Encoding");
+        msgpack::Format format = msgpack::negotiate(req.get_header_value("Accept"));
+        offload::run(req, res, [&store, accept_encoding, format, params = req.url_params](
+                                   const utils::Deadline& deadline) {
+            static PrecompressedResponse cached_body;
+            static PrecompressedResponse cached_rows(msgpack::kContentType);
+            static PrecompressedResponse cached_columns(msgpack::kContentType);
+            crow::response error;
+            auto view = VersionHandler::read(store, params, error);
+            if (!view) return error;
+            if (format != msgpack::Format::Json) {
+                auto& cached = format == msgpack::Format::Rows ? cached_rows : cached_columns;
+                return cached.serve(accept_encoding, view->generation(), view->version(), deadline, [&] {
+                    std::vector<const Airport*> airports;
+                    {
+                        ScopedPhase phase(Phase::Query);
+                        airports = view->airports_sorted_by_iata();
+                    }
 
-        return crow::response(200, json);
+                    ScopedPhase phase(Phase::Serialize);
+                    bool columns = format == msgpack::Format::Columns;
+                    msgpack::Writer out;
+                    out.reserve(airports.size() * 128);
+                    out.map(columns ? 3 : 2);
+                    out.string("airports");
+                    msgpack::write_list(out, airports, format);
+                    out.string("total");
+                    out.uinteger(airports.size());
+                    if (columns) {
+                        out.string("layout");
+                        out.string("columns");
+                    }
+                    return out.take();
+                });
+            }
+            return cached_body.serve(accept_encoding, view->generation(), view->version(), deadline, [&] {
+                std::vector<const Airport*> airports;
+                {
+                    ScopedPhase phase(Phase::Query);
+                    airports = view->airports_sorted_by_iata();
+                }
+
+                crow::json::wvalue json;
+                {
+                    ScopedPhase phase(Phase::JsonBuild);
+                    std::vector<crow::json::wvalue> airports_json;
+                    for (auto airport : airports) {
+                        if (deadline.expired()) break;
+                        airports_json.push_back(airport->to_json());
+                    }
+                    json["airports"] = std::move(airports_json);
+                    json["total"] = airports.size();
+                }
+
+                ScopedPhase phase(Phase::Serialize);
+                return json.dump();
+            });
+        });
     });
 
     // 3. Insert airport
@@ -62,21 +193,7 @@ void AirportHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStor
             return crow::response(400, "Invalid JSON");
         }
 
-        Airport airport;
-        airport.id = body["id"].i();
-        airport.name = body["name"].s();
-        airport.city = body["city"].s();
-        airport.country = body["country"].s();
-        airport.iata = body["iata"].s();
-        airport.icao = body.has("icao") ? std::string(body["icao"].s()) : "";
-        airport.latitude = body["latitude"].d();
-        airport.longitude = body["longitude"].d();
-        airport.altitude = body.has("altitude") ? body["altitude"].i() : 0;
-        airport.timezone = body.has("timezone") ? body["timezone"].d() : 0.0;
-        airport.dst = body.has("dst") ? std::string(body["dst"].s()) : "U";
-        airport.tz_database = body.has("tz_database") ? std::string(body["tz_database"].s()) : "";
-        airport.type = body.has("type") ? std::string(body["type"].s()) : "airport";
-        airport.source = body.has("source") ? std::string(body["source"].s()) : "User";
+        Airport airport = Airport::from_json(body);
 
         if (store.insert_airport(airport)) {
             return crow::response(201, airport.to_json());
@@ -108,34 +225,60 @@ void AirportHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStor
         return crow::response(404, "Airport not found");
     });
 
-    // 4. One-hop routes
+    // 4. One-hop routes (offloaded: hub-to-hub searches scan thousands of legs)
     CROW_ROUTE(app, "/api/routes/one-hop")
-    ([&store](const crow::request& req) {
-        auto source = req.url_params.get("source");
-        auto dest = req.url_params.get("dest");
-        
-        if (!source || !dest) {
-            return crow::response(400, "Missing source or dest parameter");
+    ([&store](const crow::request& req, crow::response& res) {
+        auto source_param = req.url_params.get("source");
+        auto dest_param = req.url_params.get("dest");
+
+        if (!source_param || !dest_param) {
+            res = crow::response(400, "Missing source or dest parameter");
+            res.end();
+            return;
         }
 
-        auto results = store.find_one_hop_routes(source, dest);
-        
-        crow::json::wvalue json;
-        json["source"] = source;
-        json["destination"] = dest;
-        
-        std::vector<crow::json::wvalue> routes_json;
-        for (const auto& one_hop : results) {
-            crow::json::wvalue route_data;
-            route_data["first_leg"] = one_hop.first_leg.to_json();
-            route_data["second_leg"] = one_hop.second_leg.to_json();
-            route_data["intermediate_airport"] = one_hop.intermediate_airport_iata;
-            route_data["total_distance_miles"] = one_hop.total_distance_miles;
-            routes_json.push_back(std::move(route_data));
-        }
-        json["routes"] = std::move(routes_json);
-        json["total_routes"] = results.size();
+        std::string source = source_param;
+        std::string dest = dest_param;
+        offload::run(req, res, [&store, source, dest, params = req.url_params](const utils::Deadline& deadline) {
+            crow::response error;
+            auto view = VersionHandler::read(store, params, error);
+            if (!view) return error;
+            const Airport* source_airport;
+            const Airport* dest_airport;
+            {
+                ScopedPhase phase(Phase::Lookup);
+                source_airport = view->airport_by_iata(source);
+                dest_airport = view->airport_by_iata(dest);
+            }
 
-        return crow::response(200, json);
+            // Unknown airports simply have no connections
+            OneHopCache::Result results = std::make_shared<std::vector<OneHopRoute>>();
+            if (source_airport && dest_airport) {
+                ScopedPhase phase(Phase::Query);
+                results = view->one_hop(*source_airport, *dest_airport, &deadline);
+            }
+
+            crow::json::wvalue json;
+            {
+                ScopedPhase phase(Phase::JsonBuild);
+                json["source"] = source;
+                json["destination"] = dest;
+
+                std::vector<crow::json::wvalue> routes_json;
+                for (const auto& one_hop : *results) {
+                    crow::json::wvalue route_data;
+                    route_data["first_leg"] = one_hop.first_leg.to_json();
+                    route_data["second_leg"] = one_hop.second_leg.to_json();
+                    route_data["intermediate_airport"] = one_hop.intermediate_airport_iata;
+                    route_data["total_distance_miles"] = one_hop.total_distance_miles;
+                    routes_json.push_back(std::move(route_data));
+                }
+                json["routes"] = std::move(routes_json);
+                json["total_routes"] = results->size();
+            }
+
+            ScopedPhase phase(Phase::Serialize);
+            return crow::response(200, json);
+        });
     });
 }
\ No newline at end of file
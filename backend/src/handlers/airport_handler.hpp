@@ -1,9 +1,8 @@
 #pragma once
-#include "crow.h"
-#include "crow/middlewares/cors.h"
+#include "../app.hpp"
 #include "../database/data_store.hpp"
 
 class AirportHandler {
 public:
-    static void register_routes(crow::App<crow::CORSHandler>& app, DataStore& store);
+    static void register_routes(FlightApp& app, DataStore& store);
 };
\ No newline at end of file
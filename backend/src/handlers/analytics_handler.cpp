@@ -0,0 +1,263 @@
+#include "analytics_handler.hpp"
+#include "version_handler.hpp"
+#include "../metrics/request_trace.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+using trace::Phase;
+using trace::ScopedPhase;
+
+namespace {
+
+constexpr int kDefaultLimit = 50;
+constexpr int kMaxLimit = 5000;
+constexpr size_t kMaxCachedViews = 256;
+
+// Rendered responses keyed by endpoint + parameters. An entry is reused
+// only while the store is still at the data version it was built from.
+struct CachedView {
+    uint64_t generation;
+    uint64_t version;
+    std::string body;
+};
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, CachedView> cache;
+
+crow::response json_response(std::string body) {
+    crow::response res(200, std::move(body));
+    res.set_header("Content-Type", "application/json");
+    return res;
+}
+
+// `view` is at the request's ?as_of= version when given
+crow::response serve_cached(const DataStore::ReadView& view, const std::string& key,
+                            const std::function<crow::json::wvalue(const DataStore::ReadView&)>& build) {
+    uint64_t generation = view.generation();
+    uint64_t version = view.version();
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(key);
+        if (it != cache.end() && it->second.generation == generation && it->second.version == version) {
+            return json_response(it->second.body);
+        }
+    }
+
+    crow::json::wvalue json;
+    {
+        ScopedPhase phase(Phase::Query);
+        json = build(view);
+    }
+    json["version"] = version;
+
+    std::string body;
+    {
+        ScopedPhase phase(Phase::Serialize);
+        body = json.dump();
+    }
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (cache.size() >= kMaxCachedViews) cache.clear();
+        cache[key] = {generation, version, body};
+    }
+    return json_response(std::move(body));
+}
+
+int limit_param(const crow::request& req) {
+    int limit = kDefaultLimit;
+    if (auto param = req.url_params.get("limit")) {
+        limit = std::clamp(utils::safe_stoi(param), 1, kMaxLimit);
+    }
+    return limit;
+}
+
+} // namespace
+
+void AnalyticsHandler::register_routes(FlightApp& app, DataStore& store) {
+    // Hub ranking: /api/analytics/hubs[?by=routes|pagerank|betweenness][&limit=N]
+    //
+    // "routes" ranks by total routes (in + out) and is always current;
+    // the centrality orders come from the background job and report the
+    // data version they were computed at.
+    CROW_ROUTE(app, "/api/analytics/hubs")
+    ([&store](const crow::request& req) {
+        int limit = limit_param(req);
+        std::string by = req.url_params.get("by") ? req.url_params.get("by") : "routes";
+        if (by != "routes" && by != "pagerank" && by != "betweenness") {
+            return crow::response(400, "by must be routes, pagerank or betweenness");
+        }
+
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+
+        // Centrality is published separately from the data, so its version
+        // is part of the cache key. A pinned version has its own copy.
+        auto scores = view->centrality();
+        if (by != "routes" && !scores) {
+            return crow::response(503, "Centrality not computed yet");
+        }
+        std::string key = "hubs?" + std::to_string(limit) + "&" + by;
+        if (scores) key += "&" + std::to_string(scores->generation) + "." + std::to_string(scores->version);
+
+        return serve_cached(*view, key, [limit, by, scores](const DataStore::ReadView& view) {
+            const auto& stats = view.analytics().airport_stats();
+            std::vector<int> hubs;
+            if (by == "routes") {
+                for (const auto& [airport_id, airport_stats] : stats) {
+                    hubs.push_back(airport_id);
+                }
+                auto total = [&](int id) {
+                    const auto& s = stats.at(id);
+                    return s.routes_out + s.routes_in;
+                };
+                size_t count = std::min<size_t>(limit, hubs.size());
+                std::partial_sort(hubs.begin(), hubs.begin() + count, hubs.end(),
+                                  [&](int a, int b) {
+                                      return total(a) != total(b) ? total(a) > total(b) : a < b;
+                                  });
+                hubs.resize(count);
+            } else {
+                const auto& ranked = by == "pagerank" ? scores->by_pagerank : scores->by_betweenness;
+                hubs.assign(ranked.begin(), ranked.begin() + std::min<size_t>(limit, ranked.size()));
+            }
+
+            crow::json::wvalue json;
+            std::vector<crow::json::wvalue> hubs_json;
+            for (int airport_id : hubs) {
+                crow::json::wvalue item;
+                if (auto airport = view.airport_by_id(airport_id)) {
+                    item["iata"] = airport->iata;
+                    item["name"] = airport->name;
+                    item["country"] = airport->country;
+                }
+                item["airport_id"] = airport_id;
+                auto airport_stats = stats.find(airport_id);
+                if (airport_stats != stats.end()) {
+                    item["routes_out"] = airport_stats->second.routes_out;
+                    item["routes_in"] = airport_stats->second.routes_in;
+                    item["destinations"] = airport_stats->second.destinations;
+                }
+                if (scores) {
+                    auto centrality = scores->airports.find(airport_id);
+                    if (centrality != scores->airports.end()) {
+                        item["pagerank"] = centrality->second.pagerank;
+                        item["betweenness"] = centrality->second.betweenness;
+                    }
+                }
+                hubs_json.push_back(std::move(item));
+            }
+            json["hubs"] = std::move(hubs_json);
+            json["by"] = by;
+            json["total_airports"] = stats.size();
+            if (scores) {
+                json["centrality_version"] = scores->version;
+                json["centrality_sampled_sources"] = scores->sampled_sources;
+                json["centrality_compute_seconds"] = scores->compute_seconds;
+            }
+            return json;
+        });
+    });
+
+    // Country-to-country route counts: /api/analytics/country-matrix[?country=X][&limit=N]
+    CROW_ROUTE(app, "/api/analytics/country-matrix")
+    ([&store](const crow::request& req) {
+        int limit = limit_param(req);
+        std::string country = req.url_params.get("country") ? req.url_params.get("country") : "";
+        std::string key = "country-matrix?" + std::to_string(limit) + "&" + country;
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        return serve_cached(*view, key, [limit, country](const DataStore::ReadView& view) {
+            using Cell = std::pair<const std::pair<std::string, std::string>*, int>;
+            std::vector<Cell> cells;
+            for (const auto& [countries, routes] : view.analytics().country_matrix()) {
+                if (country.empty() || countries.first == country || countries.second == country) {
+                    cells.emplace_back(&countries, routes);
+                }
+            }
+            size_t count = std::min<size_t>(limit, cells.size());
+            std::partial_sort(cells.begin(), cells.begin() + count, cells.end(),
+                              [](const Cell& a, const Cell& b) {
+                                  return a.second != b.second ? a.second > b.second : *a.first < *b.first;
+                              });
+
+            crow::json::wvalue json;
+            std::vector<crow::json::wvalue> cells_json;
+            for (size_t i = 0; i < count; ++i) {
+                crow::json::wvalue item;
+                item["from"] = cells[i].first->first;
+                item["to"] = cells[i].first->second;
+                item["routes"] = cells[i].second;
+                cells_json.push_back(std::move(item));
+            }
+            json["cells"] = std::move(cells_json);
+            json["total_cells"] = cells.size();
+            return json;
+        });
+    });
+
+    // Number of airports per distinct nonstop destination count
+    CROW_ROUTE(app, "/api/analytics/degree-distribution")
+    ([&store](const crow::request& req) {
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        return serve_cached(*view, "degree-distribution", [](const DataStore::ReadView& view) {
+            crow::json::wvalue json;
+            std::vector<crow::json::wvalue> buckets_json;
+            for (const auto& bucket : view.analytics().degree_distribution()) {
+                crow::json::wvalue item;
+                item["degree"] = bucket.degree;
+                item["airports"] = bucket.airports;
+                buckets_json.push_back(std::move(item));
+            }
+            json["distribution"] = std::move(buckets_json);
+            return json;
+        });
+    });
+
+    // Per-airline network size: routes and airports served
+    CROW_ROUTE(app, "/api/analytics/airlines")
+    ([&store](const crow::request& req) {
+        int limit = limit_param(req);
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        return serve_cached(*view, "airlines?" + std::to_string(limit), [limit](const DataStore::ReadView& view) {
+            using Entry = std::pair<int, const NetworkAnalytics::AirlineStats*>;
+            std::vector<Entry> airlines;
+            for (const auto& [airline_id, stats] : view.analytics().airline_stats()) {
+                airlines.emplace_back(airline_id, &stats);
+            }
+            size_t count = std::min<size_t>(limit, airlines.size());
+            std::partial_sort(airlines.begin(), airlines.begin() + count, airlines.end(),
+                              [](const Entry& a, const Entry& b) {
+                                  return a.second->routes != b.second->routes
+                                             ? a.second->routes > b.second->routes
+                                             : a.first < b.first;
+                              });
+
+            crow::json::wvalue json;
+            std::vector<crow::json::wvalue> airlines_json;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& [airline_id, stats] = airlines[i];
+                crow::json::wvalue item;
+                if (auto airline = view.airline_by_id(airline_id)) {
+                    item["iata"] = airline->iata;
+                    item["name"] = airline->name;
+                }
+                item["airline_id"] = airline_id;
+                item["routes"] = stats->routes;
+                item["airports"] = stats->airports.size();
+                airlines_json.push_back(std::move(item));
+            }
+            json["airlines"] = std::move(airlines_json);
+            json["total_airlines"] = airlines.size();
+            return json;
+        });
+    });
+}
@@ -0,0 +1,225 @@
+#include "change_handler.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Upper bounds for client-supplied parameters
+constexpr int kMaxWaitSeconds = 30;
+constexpr int kDefaultSseWaitSeconds = 25;
+constexpr int kMaxBatch = 5000;
+constexpr int kDefaultBatch = 1000;
+
+// Long-polls parked at once; further ones are refused with 503
+constexpr size_t kMaxWaiters = 1024;
+
+bool wants_event_stream(const crow::request& req) {
+    return req.get_header_value("Accept").find("text/event-stream") != std::string::npos;
+}
+
+crow::response event_stream(std::string body) {
+    crow::response res(200, std::move(body));
+    res.set_header("Content-Type", "text/event-stream");
+    res.set_header("Cache-Control", "no-cache");
+    return res;
+}
+
+// The consumer's position is unusable: 410 once it has fallen out of the
+// ring, 409 when it is ahead of the log (it outlived a restart or a replica
+// resync). Either way it must resync from the full lists.
+crow::response resync(const ChangeLog& log, uint64_t since, bool ahead, bool sse) {
+    crow::json::wvalue json;
+    json["error"] = ahead ? "Sequence is ahead of the change log, resync required"
+                          : "Sequence no longer available, resync required";
+    json["since"] = since;
+    json["oldest_seq"] = log.oldest_seq();
+    json["current_seq"] = log.current_seq();
+    if (sse) return event_stream("event: reset\ndata: " + json.dump() + "\n\n");
+    return crow::response(ahead ? 409 : 410, json);
+}
+
+// Events after `since`, as JSON or one round of Server-Sent Events
+crow::response changes(const ChangeLog& log, uint64_t since, size_t limit, bool sse) {
+    if (since > log.current_seq()) return resync(log, since, true, sse);
+
+    std::vector<ChangeEvent> events;
+    if (!log.read_since(since, limit, events)) return resync(log, since, false, sse);
+
+    if (sse) {
+        std::string body = "retry: 1000\n\n";
+        for (const auto& event : events) {
+            body += event.to_sse();
+        }
+        if (events.empty()) {
+            // Keep-alive comment so proxies do not treat the round as an error
+            body += ": no changes\n\n";
+        }
+        return event_stream(std::move(body));
+    }
+
+    crow::json::wvalue json;
+    std::vector<crow::json::wvalue> events_json;
+    for (const auto& event : events) {
+        events_json.push_back(event.to_json());
+    }
+    json["events"] = std::move(events_json);
+    json["since"] = since;
+    json["last_seq"] = events.empty() ? since : events.back().seq;
+    json["current_seq"] = log.current_seq();
+
+    return crow::response(200, json);
+}
+
+// Long-polls waiting for their first event. The handler returns to Crow
+// straight away, so a waiting client holds no IO thread; this class's
+// thread finishes the response once the log moves past the client's
+// position or its timeout passes.
+class LongPolls {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Complete = std::function<void()>;
+
+    explicit LongPolls(const ChangeLog& log) : log_(log), thread_([this]() { run(); }) {}
+
+    ~LongPolls() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+    }
+
+    // Wake the thread; called from ChangeLog listeners
+    void notify() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            changed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    // Run `complete` once the log is past `since` or at `until`; false if
+    // too many requests are parked already
+    bool park(uint64_t since, Clock::time_point until, Complete complete) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (waiters_.size() >= kMaxWaiters) return false;
+            waiters_.push_back({since, until, std::move(complete)});
+            changed_ = true;
+        }
+        cv_.notify_all();
+        return true;
+    }
+
+private:
+    struct Waiter {
+        uint64_t since;
+        Clock::time_point until;
+        Complete complete;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            if (waiters_.empty()) {
+                cv_.wait(lock, [this]() { return stop_ || changed_; });
+            } else {
+                auto next = std::min_element(waiters_.begin(), waiters_.end(),
+                                             [](const Waiter& a, const Waiter& b) { return a.until < b.until; });
+                cv_.wait_until(lock, next->until, [this]() { return stop_ || changed_; });
+            }
+            if (stop_) break;
+            changed_ = false;
+
+            // Any change to the log, a reset included, answers a waiter
+            uint64_t current = log_.current_seq();
+            auto now = Clock::now();
+            auto waiting = std::partition(waiters_.begin(), waiters_.end(), [&](const Waiter& waiter) {
+                return waiter.since == current && waiter.until > now;
+            });
+            std::vector<Waiter> ready(std::make_move_iterator(waiting), std::make_move_iterator(waiters_.end()));
+            waiters_.erase(waiting, waiters_.end());
+
+            lock.unlock();
+            for (auto& waiter : ready) waiter.complete();
+            lock.lock();
+        }
+    }
+
+    const ChangeLog& log_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Waiter> waiters_;
+    bool changed_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+} // namespace
+
+void ChangeHandler::register_routes(FlightApp& app, DataStore& store) {
+    auto polls = std::make_shared<LongPolls>(store.get_change_log());
+    store.get_change_log().add_listener([weak = std::weak_ptr<LongPolls>(polls)]() {
+        if (auto polls = weak.lock()) polls->notify();
+    });
+
+    // Change feed: /api/changes?since=<seq>[&timeout=<seconds>][&limit=<n>]
+    //
+    // Returns mutations with seq > since. If there are none yet and a timeout
+    // is given, the request is held open until one arrives (long-polling).
+    // With "Accept: text/event-stream" the batch is written as Server-Sent
+    // Events; EventSource reconnects on its own and resumes from
+    // Last-Event-ID, so each response is one long-poll round. A position
+    // the log can no longer serve is answered 410 (fell behind the ring) or
+    // 409 (ahead of the log), and the consumer resyncs from the full lists.
+    CROW_ROUTE(app, "/api/changes")
+    ([&store, polls](const crow::request& req, crow::response& res) {
+        const ChangeLog& log = store.get_change_log();
+        bool sse = wants_event_stream(req);
+
+        uint64_t since = 0;
+        const std::string& last_event_id = req.get_header_value("Last-Event-ID");
+        if (auto param = req.url_params.get("since")) {
+            since = std::strtoull(param, nullptr, 10);
+        } else if (!last_event_id.empty()) {
+            since = std::strtoull(last_event_id.c_str(), nullptr, 10);
+        } else if (sse) {
+            // A fresh stream starts from "now"
+            since = log.current_seq();
+        }
+
+        int timeout = sse ? kDefaultSseWaitSeconds : 0;
+        if (auto param = req.url_params.get("timeout")) {
+            timeout = std::clamp(utils::safe_stoi(param), 0, kMaxWaitSeconds);
+        }
+
+        size_t limit = kDefaultBatch;
+        if (auto param = req.url_params.get("limit")) {
+            limit = static_cast<size_t>(std::clamp(utils::safe_stoi(param), 1, kMaxBatch));
+        }
+
+        if (timeout == 0 || since != log.current_seq()) {
+            res = changes(log, since, limit, sse);
+            res.end();
+            return;
+        }
+
+        auto until = LongPolls::Clock::now() + std::chrono::seconds(timeout);
+        bool parked = polls->park(since, until, [&log, &res, since, limit, sse]() {
+            res = changes(log, since, limit, sse);
+            res.end();
+        });
+        if (!parked) {
+            res = crow::response(503, "Too many waiting change feed requests");
+            res.set_header("Retry-After", "1");
+            res.end();
+        }
+    });
+}
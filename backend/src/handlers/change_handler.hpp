@@ -0,0 +1,8 @@
+#pragma once
+#include "../app.hpp"
+#include "../database/data_store.hpp"
+
+class ChangeHandler {
+public:
+    static void register_routes(FlightApp& app, DataStore& store);
+};
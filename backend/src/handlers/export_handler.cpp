@@ -0,0 +1,205 @@
+#include "export_handler.hpp"
+#include "query_offload.hpp"
+#include "version_handler.hpp"
+#include "../metrics/request_trace.hpp"
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <unistd.h>
+
+using trace::Phase;
+using trace::ScopedPhase;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Rows are formatted into this much memory at a time, whatever the table size
+constexpr size_t kBufferBytes = 64 * 1024;
+
+// Exports kept per table. Older files are unlinked, which is safe for
+// responses still streaming them.
+constexpr size_t kFilesKept = 3;
+
+// Exports written to disk once per table and version, then streamed by
+// Crow's static file writer. Crow has no chunked response body, so this is
+// how a large table leaves the process without being held in memory.
+// Versions are (change-log generation, sequence) pairs, since a replica's
+// reset can reuse a sequence number.
+class ExportFiles {
+public:
+    using Version = std::pair<uint64_t, uint64_t>;
+
+    ExportFiles() {
+        std::error_code ec;
+        dir_ = fs::temp_directory_path(ec) / ("flight-export-" + std::to_string(::getpid()));
+        fs::create_directories(dir_, ec);
+        if (ec) std::cerr << "Export: cannot create " << dir_ << ": " << ec.message() << std::endl;
+    }
+
+    ~ExportFiles() {
+        std::error_code ec;
+        fs::remove_all(dir_, ec);
+    }
+
+    // Path of the `table` export at `version`, if it has been written
+    std::optional<std::string> find(const std::string& table, const Version& version) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [file_version, path] : files_[table]) {
+            if (file_version == version) return path;
+        }
+        return std::nullopt;
+    }
+
+    // Write the export for `table` at `version` via `write(out)`, publishing
+    // it with a rename so readers never see a partial file; nullopt if
+    // writing failed or `write` gave up
+    template <typename Write>
+    std::optional<std::string> create(const std::string& table, const Version& version, Write write) {
+        std::string name = table + "-" + std::to_string(version.first) + "-" + std::to_string(version.second);
+        std::string path = (dir_ / (name + ".csv")).string();
+        std::string tmp;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tmp = path + ".tmp." + std::to_string(next_tmp_++);
+        }
+
+        bool ok;
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            ok = out.is_open() && write(out);
+            out.close();
+            ok = ok && !out.fail();
+        }
+        std::error_code ec;
+        if (ok) fs::rename(tmp, path, ec);
+        if (!ok || ec) {
+            fs::remove(tmp, ec);
+            return std::nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& files = files_[table];
+        for (const auto& file : files) {
+            // A concurrent export of the same version won the race; the
+            // rename above replaced its file in place
+            if (file.first == version) return path;
+        }
+        files.emplace_back(version, path);
+        while (files.size() > kFilesKept) {
+            fs::remove(files.front().second, ec);
+            files.pop_front();
+        }
+        return path;
+    }
+
+private:
+    fs::path dir_;
+    std::mutex mutex_;
+    // table -> (version, path), oldest first
+    std::map<std::string, std::deque<std::pair<Version, std::string>>> files_;
+    uint64_t next_tmp_ = 0;
+};
+
+ExportFiles& export_files() {
+    static ExportFiles files;
+    return files;
+}
+
+// Format `rows` through a fixed buffer; false if `deadline` expires first
+template <typename Rows>
+bool write_rows(std::ofstream& out, const Rows& rows, const utils::Deadline& deadline) {
+    std::string buffer;
+    buffer.reserve(kBufferBytes + 1024);
+    for (const auto& row : rows) {
+        // Tables hold records by value, id-ordered lists hold pointers
+        if constexpr (std::is_pointer_v<std::decay_t<decltype(row)>>) {
+            row->append_csv(buffer);
+        } else {
+            row.append_csv(buffer);
+        }
+        buffer += '\n';
+        if (buffer.size() >= kBufferBytes) {
+            if (deadline.expired()) return false;
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return true;
+}
+
+crow::response file_response(const std::string& path, const std::string& table, uint64_t version) {
+    crow::response res;
+    res.set_static_file_info_unsafe(path);
+    res.set_header("Content-Type", "text/csv; charset=utf-8");
+    res.set_header("Content-Disposition",
+                   "attachment; filename=\"" + table + "-" + std::to_string(version) + ".csv\"");
+    res.set_header("X-Data-Version", std::to_string(version));
+    return res;
+}
+
+// Export `table` at the requested version; `rows(view)` lists its records
+template <typename Rows>
+offload::Work export_work(DataStore& store, std::string table, crow::query_string params, Rows rows) {
+    return [&store, table = std::move(table), params = std::move(params), rows](const utils::Deadline& deadline) {
+        crow::response error;
+        auto view = VersionHandler::read(store, params, error);
+        if (!view) return error;
+        ExportFiles::Version key{view->generation(), view->version()};
+
+        auto path = export_files().find(table, key);
+        if (!path && !view->frozen()) {
+            // Writing takes a while, so it reads a frozen copy rather than
+            // hold the live store's shared lock against writers. The copy
+            // is of the then current version, which may be newer.
+            view.reset();
+            view = store.read_frozen();
+            key = {view->generation(), view->version()};
+            path = export_files().find(table, key);
+        }
+        if (!path) {
+            ScopedPhase phase(Phase::Serialize);
+            path = export_files().create(table, key, [&](std::ofstream& out) {
+                return write_rows(out, rows(*view), deadline);
+            });
+        }
+        if (!path) {
+            if (deadline.expired()) return crow::response(504, "Query deadline exceeded");
+            return crow::response(500, "Export failed");
+        }
+        return file_response(*path, table, key.second);
+    };
+}
+
+} // namespace
+
+void ExportHandler::register_routes(FlightApp& app, DataStore& store) {
+    // Whole tables as CSV, airports and airlines in id order and routes in
+    // table order: GET /api/export/<table>.csv[?as_of=<version>]
+    CROW_ROUTE(app, "/api/export/airports.csv")
+    ([&store](const crow::request& req, crow::response& res) {
+        offload::run(req, res, export_work(store, "airports", req.url_params,
+                                           [](const DataStore::ReadView& view) { return view.airports_by_id(); }));
+    });
+
+    CROW_ROUTE(app, "/api/export/airlines.csv")
+    ([&store](const crow::request& req, crow::response& res) {
+        offload::run(req, res, export_work(store, "airlines", req.url_params,
+                                           [](const DataStore::ReadView& view) { return view.airlines_by_id(); }));
+    });
+
+    CROW_ROUTE(app, "/api/export/routes.csv")
+    ([&store](const crow::request& req, crow::response& res) {
+        offload::run(req, res, export_work(store, "routes", req.url_params,
+                                           [](const DataStore::ReadView& view) -> const std::vector<Route>& {
+                                               return view.routes();
+                                           }));
+    });
+}
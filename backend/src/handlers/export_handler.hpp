@@ -0,0 +1,12 @@
+#pragma once
+#include "../app.hpp"
+#include "../database/data_store.hpp"
+
+// Full-table CSV downloads in the data files' own format (no header row,
+// RFC 4180 quoting), so an export loads back through CSVParser unchanged.
+// Each export is one consistent version, ?as_of=<version> included, and
+// is written from a frozen copy so writers carry on meanwhile.
+class ExportHandler {
+public:
+    static void register_routes(FlightApp& app, DataStore& store);
+};
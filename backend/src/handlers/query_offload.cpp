@@ -0,0 +1,72 @@
+#include "query_offload.hpp"
+#include "../metrics/metrics.hpp"
+#include "../metrics/request_trace.hpp"
+#include "../metrics/slow_query_log.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace offload {
+
+namespace {
+
+std::atomic<utils::Executor*> g_executor{nullptr};
+std::atomic<int64_t> g_budget_ms{2000};
+
+crow::response complete(const Work& work, const utils::Deadline& deadline) {
+    static const auto timeouts = metrics::counter(
+        "flight_query_deadline_exceeded_total", "", "Offloaded queries answered with 504");
+
+    // Work cut short by the deadline may be partial, so it is discarded
+    if (!deadline.expired()) {
+        crow::response response = work(deadline);
+        if (!deadline.expired()) return response;
+    }
+    timeouts.inc();
+    return crow::response(504, "Query deadline exceeded");
+}
+
+} // namespace
+
+void configure(utils::Executor* executor, std::chrono::milliseconds budget) {
+    g_executor.store(executor);
+    g_budget_ms.store(budget.count());
+}
+
+void run(const crow::request& req, crow::response& res, Work work) {
+    static const auto queue_time = metrics::histogram(
+        "flight_query_queue_seconds", "", "Time offloaded queries wait for a worker", 1e-6);
+
+    int64_t budget_ms = g_budget_ms.load();
+    if (auto param = req.url_params.get("timeout_ms")) {
+        budget_ms = std::clamp<int64_t>(utils::safe_stoi(param), 1, budget_ms);
+    }
+    auto deadline = std::make_shared<utils::Deadline>(std::chrono::milliseconds(budget_ms));
+    // Checked when the work starts and every few deadline polls while it runs
+    deadline->set_probe([&res]() { return res.is_alive(); });
+
+    utils::Executor* executor = g_executor.load();
+    if (!executor) {
+        res = complete(work, *deadline);
+        res.end();
+        return;
+    }
+
+    // The trace and slow-log plan follow the request onto the worker, which
+    // also runs the middleware's after_handle when it ends the response
+    trace::RequestTrace* request_trace = trace::detach();
+    auto accepted = std::chrono::steady_clock::now();
+    executor->submit([&res, work = std::move(work), deadline, request_trace, accepted]() {
+        queue_time.observe(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - accepted).count());
+        trace::attach(request_trace);
+        slow_log::begin_request();
+
+        res = complete(work, *deadline);
+        res.end();
+        trace::set_current(nullptr);
+    });
+}
+
+} // namespace offload
@@ -0,0 +1,26 @@
+#pragma once
+#include "crow.h"
+#include "../utils/deadline.hpp"
+#include "../utils/executor.hpp"
+#include <chrono>
+#include <functional>
+
+// Moves heavy handlers (one-hop search, full list serialization, route
+// filters) off Crow's IO threads onto the query executor, completing the
+// response from there, so a slow query only delays its own connection.
+// Cheap lookups keep running inline.
+//
+// Each offloaded request carries a Deadline that starts when the request
+// is accepted, so queueing counts against it; ?timeout_ms=<n> can shorten
+// it. Work polls the deadline and stops early once it passes or the client
+// disconnects, and the request is answered with 504.
+namespace offload {
+
+using Work = std::function<crow::response(const utils::Deadline&)>;
+
+// With no executor (the default) work runs inline, still under a deadline
+void configure(utils::Executor* executor, std::chrono::milliseconds budget);
+
+void run(const crow::request& req, crow::response& res, Work work);
+
+} // namespace offload
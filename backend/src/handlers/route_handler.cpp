@@ -1,6 +1,195 @@
 #include "route_handler.hpp"
+#include "query_offload.hpp"
+#include "version_handler.hpp"
+#include "../encoding/msgpack.hpp"
+#include "../metrics/request_trace.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+using trace::Phase;
+using trace::ScopedPhase;
+
+namespace {
+
+constexpr size_t kMaxRouteLimit = 10000;
+constexpr size_t kDefaultRouteLimit = 1000;
+
+// IATA first, then ICAO, so either kind of code works in filters
+const Airport* resolve_airport(const DataStore::ReadView& view, const std::string& code) {
+    auto airport = view.airport_by_iata(code);
+    return airport ? airport : view.airport_by_icao(code);
+}
+
+const Airline* resolve_airline(const DataStore::ReadView& view, const std::string& code) {
+    auto airline = view.airline_by_iata(code);
+    return airline ? airline : view.airline_by_icao(code);
+}
+
+} // namespace
+
+void RouteHandler::register_routes(FlightApp& app, DataStore& store) {
+    // Filter routes: /api/routes?airline=&source=&dest=&stops=&equipment=&codeshare=Y|N
+    // [&limit=<n>][&offset=<n>]
+    //
+    // All given predicates must match. Airlines and airports are given by
+    // IATA or ICAO code; an unknown code matches nothing. Offloaded, since
+    // broad filters serialize up to kMaxRouteLimit routes. MessagePack
+    // clients get the page encoded straight from the routes.
+    CROW_ROUTE(app, "/api/routes")
+    ([&store](const crow::request& req, crow::response& res) {
+        msgpack::Format format = msgpack::negotiate(req.get_header_value("Accept"));
+        offload::run(req, res, [&store, format, params = req.url_params](const utils::Deadline& deadline) {
+            crow::response error;
+            auto view = VersionHandler::read(store, params, error);
+            if (!view) return error;
+            RouteFilter filter;
+            bool unknown_code = false;
+            {
+                ScopedPhase phase(Phase::Lookup);
+                if (auto param = params.get("airline")) {
+                    auto airline = resolve_airline(*view, param);
+                    unknown_code |= !airline;
+                    if (airline) filter.airline_id = airline->id;
+                }
+                if (auto param = params.get("source")) {
+                    auto airport = resolve_airport(*view, param);
+                    unknown_code |= !airport;
+                    if (airport) filter.source_airport_id = airport->id;
+                }
+                if (auto param = params.get("dest")) {
+                    auto airport = resolve_airport(*view, param);
+                    unknown_code |= !airport;
+                    if (airport) filter.dest_airport_id = airport->id;
+                }
+            }
+            if (auto param = params.get("stops")) {
+                // A typo must not silently become stops=0
+                char* end = nullptr;
+                errno = 0;
+                long stops = std::strtol(param, &end, 10);
+                if (*param == '\0' || *end != '\0' || errno != 0 || stops < 0 || stops > INT_MAX) {
+                    return crow::response(400, "Invalid stops value");
+                }
+                filter.stops = static_cast<int>(stops);
+            }
+            if (auto param = params.get("equipment")) {
+                filter.equipment = utils::to_upper(param);
+            }
+            if (auto param = params.get("codeshare")) {
+                filter.codeshare = utils::to_upper(param) == "Y";
+            }
+
+            size_t limit = kDefaultRouteLimit;
+            if (auto param = params.get("limit")) {
+                limit = std::clamp<size_t>(utils::safe_stoi(param), 1, kMaxRouteLimit);
+            }
+            size_t offset = 0;
+            if (auto param = params.get("offset")) {
+                offset = std::max(0, utils::safe_stoi(param));
+            }
+
+            std::vector<const Route*> routes;
+            if (!unknown_code) {
+                ScopedPhase phase(Phase::Query);
+                routes = view->filter_routes(filter);
+            }
+
+            if (format != msgpack::Format::Json) {
+                ScopedPhase phase(Phase::Serialize);
+                size_t begin = std::min(offset, routes.size());
+                size_t end = begin + std::min(limit, routes.size() - begin);
+                std::vector<const Route*> page(routes.begin() + begin, routes.begin() + end);
+
+                bool columns = format == msgpack::Format::Columns;
+                msgpack::Writer out;
+                out.reserve(page.size() * 96);
+                out.map(columns ? 5 : 4);
+                out.string("routes");
+                msgpack::write_list(out, page, format);
+                out.string("total");
+                out.uinteger(routes.size());
+                out.string("offset");
+                out.uinteger(offset);
+                out.string("limit");
+                out.uinteger(limit);
+                if (columns) {
+                    out.string("layout");
+                    out.string("columns");
+                }
+
+                crow::response packed(200, out.take());
+                packed.set_header("Content-Type", msgpack::kContentType);
+                return packed;
+            }
+
+            crow::json::wvalue json;
+            {
+                ScopedPhase phase(Phase::JsonBuild);
+                std::vector<crow::json::wvalue> routes_json;
+                for (size_t i = offset; i < routes.size() && i < offset + limit; ++i) {
+                    if (deadline.expired()) break;
+                    routes_json.push_back(routes[i]->to_json());
+                }
+                json["routes"] = std::move(routes_json);
+                json["total"] = routes.size();
+                json["offset"] = offset;
+                json["limit"] = limit;
+            }
+
+            ScopedPhase phase(Phase::Serialize);
+            return crow::response(200, json);
+        });
+    });
+
+    // Reachability: /api/routes/reachable?source=X&dest=Y
+    //
+    // Answers from the maintained labeling without searching. min_legs is
+    // a lower bound on the nonstop legs any itinerary needs (exact for 0
+    // and 1); it is omitted when dest cannot be reached.
+    CROW_ROUTE(app, "/api/routes/reachable")
+    ([&store](const crow::request& req) {
+        auto source = req.url_params.get("source");
+        auto dest = req.url_params.get("dest");
+        if (!source || !dest) {
+            return crow::response(400, "Missing source or dest parameter");
+        }
+
+        crow::response error;
+        auto view = VersionHandler::read(store, req.url_params, error);
+        if (!view) return error;
+        const Airport* source_airport;
+        const Airport* dest_airport;
+        {
+            ScopedPhase phase(Phase::Lookup);
+            source_airport = resolve_airport(*view, source);
+            dest_airport = resolve_airport(*view, dest);
+        }
+        if (!source_airport || !dest_airport) {
+            return crow::response(404, "Airport not found");
+        }
+
+        int min_legs;
+        {
+            ScopedPhase phase(Phase::Query);
+            min_legs = view->hop_lower_bound(*source_airport, *dest_airport);
+        }
+
+        crow::json::wvalue json;
+        json["source"] = source_airport->iata;
+        json["destination"] = dest_airport->iata;
+        json["reachable"] = min_legs >= 0;
+        if (min_legs >= 0) {
+            json["min_legs"] = min_legs;
+        }
+        json["version"] = view->version();
+
+        ScopedPhase phase(Phase::Serialize);
+        return crow::response(200, json);
+    });
 
-void RouteHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStore& store) {
     // 2.3 Get system ID
     CROW_ROUTE(app, "/api/system/id")
     ([&store]() {
@@ -19,16 +208,7 @@ void RouteHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStore&
             return crow::response(400, "Invalid JSON");
         }
 
-        Route route;
-        route.airline_iata = body.has("airline_iata") ? std::string(body["airline_iata"].s()) : "";
-        route.airline_id = body["airline_id"].i();
-        route.source_airport_iata = body.has("source_airport_iata") ? std::string(body["source_airport_iata"].s()) : "";
-        route.source_airport_id = body["source_airport_id"].i();
-        route.dest_airport_iata = body.has("dest_airport_iata") ? std::string(body["dest_airport_iata"].s()) : "";
-        route.dest_airport_id = body["dest_airport_id"].i();
-        route.codeshare = body.has("codeshare") ? std::string(body["codeshare"].s()) : "";
-        route.stops = body.has("stops") ? body["stops"].i() : 0;
-        route.equipment = body.has("equipment") ? std::string(body["equipment"].s()) : "";
+        Route route = Route::from_json(body);
 
         if (store.insert_route(route)) {
             return crow::response(201, route.to_json());
@@ -66,6 +246,23 @@ void RouteHandler::register_routes(crow::App<crow::CORSHandler>& app, DataStore&
         json["airports"] = store.get_airport_count();
         json["airlines"] = store.get_airline_count();
         json["routes"] = store.get_route_count();
+        json["change_seq"] = store.get_change_log().current_seq();
+
+        auto cache = store.get_one_hop_cache_stats();
+        uint64_t lookups = cache.hits + cache.misses;
+        json["one_hop_cache"]["entries"] = cache.entries;
+        json["one_hop_cache"]["hits"] = cache.hits;
+        json["one_hop_cache"]["misses"] = cache.misses;
+        json["one_hop_cache"]["hit_rate"] = lookups ? double(cache.hits) / lookups : 0.0;
+        json["one_hop_cache"]["evictions"] = cache.evictions;
+        json["one_hop_cache"]["invalidations"] = cache.invalidations;
+
+        // Bytes graph queries scan in the hot records vs the full entities
+        auto footprint = store.get_hot_footprint();
+        json["hot_records"]["airport_bytes"] = footprint.airport_hot_bytes;
+        json["hot_records"]["airport_full_bytes"] = footprint.airport_full_bytes;
+        json["hot_records"]["route_bytes"] = footprint.route_hot_bytes;
+        json["hot_records"]["route_full_bytes"] = footprint.route_full_bytes;
         return crow::response(200, json);
     });
 }
\ No newline at end of file
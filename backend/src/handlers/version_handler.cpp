@@ -0,0 +1,90 @@
+#include "version_handler.hpp"
+#include "query_offload.hpp"
+#include "../utils/string_utils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+
+constexpr int kDefaultPinSeconds = 300;
+constexpr int kMaxPinSeconds = 3600;
+
+crow::json::wvalue pin_json(const VersionPins::Pin& pin) {
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(
+        pin.expires - VersionPins::Clock::now());
+    crow::json::wvalue json;
+    json["pin"] = pin.id;
+    json["version"] = pin.version;
+    json["expires_in"] = std::max<int64_t>(0, remaining.count());
+    return json;
+}
+
+} // namespace
+
+std::optional<DataStore::ReadView> VersionHandler::read(const DataStore& store, const crow::query_string& params,
+                                                        crow::response& error) {
+    std::optional<uint64_t> version;
+    if (auto param = params.get("as_of")) {
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long value = std::strtoull(param, &end, 10);
+        if (*param == '\0' || *param == '-' || *end != '\0' || errno != 0) {
+            error = crow::response(400, "Invalid as_of version");
+            return std::nullopt;
+        }
+        version = value;
+    }
+
+    auto view = store.read_at(version);
+    if (!view) {
+        error = crow::response(410, "Version " + std::to_string(*version) +
+                                    " is no longer available; pin it with POST /api/versions/pin");
+    }
+    return view;
+}
+
+void VersionHandler::register_routes(FlightApp& app, DataStore& store) {
+    // Pin the current version: POST /api/versions/pin[?ttl=<seconds>]
+    //
+    // Reads given ?as_of=<version> then all see that version, however many
+    // writes land meanwhile, until the pin is deleted or expires. Offloaded,
+    // since the first pin of a version copies the whole store.
+    CROW_ROUTE(app, "/api/versions/pin").methods(crow::HTTPMethod::POST)
+    ([&store](const crow::request& req, crow::response& res) {
+        int ttl = kDefaultPinSeconds;
+        if (auto param = req.url_params.get("ttl")) {
+            ttl = std::clamp(utils::safe_stoi(param, kDefaultPinSeconds), 1, kMaxPinSeconds);
+        }
+        offload::run(req, res, [&store, ttl](const utils::Deadline& /*deadline*/) {
+            auto pin = store.pin(std::chrono::seconds(ttl));
+            if (!pin) {
+                return crow::response(503, "Too many pinned versions; release one first");
+            }
+            return crow::response(201, pin_json(*pin));
+        });
+    });
+
+    // Release a pin: DELETE /api/versions/pin/<id>
+    CROW_ROUTE(app, "/api/versions/pin/<int>").methods(crow::HTTPMethod::DELETE)
+    ([&store](int id) {
+        if (id <= 0 || !store.unpin(static_cast<uint64_t>(id))) {
+            return crow::response(404, "Pin not found");
+        }
+        return crow::response(204);
+    });
+
+    // Current version and live pins
+    CROW_ROUTE(app, "/api/versions")
+    ([&store]() {
+        crow::json::wvalue json;
+        json["current"] = store.get_change_log().current_seq();
+        std::vector<crow::json::wvalue> pins_json;
+        for (const auto& pin : store.pins()) {
+            pins_json.push_back(pin_json(pin));
+        }
+        json["pins"] = std::move(pins_json);
+        json["retained_versions"] = store.retained_versions();
+        return crow::response(200, json);
+    });
+}
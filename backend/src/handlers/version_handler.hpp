@@ -0,0 +1,15 @@
+#pragma once
+#include "../app.hpp"
+#include "../database/data_store.hpp"
+#include <optional>
+
+class VersionHandler {
+public:
+    static void register_routes(FlightApp& app, DataStore& store);
+
+    // View for a read that may carry ?as_of=<version>: the pinned version
+    // it names, or the current data without it. Nullopt, with `error` set,
+    // for a malformed version (400) or one no longer held (410).
+    static std::optional<DataStore::ReadView> read(const DataStore& store, const crow::query_string& params,
+                                                   crow::response& error);
+};
@@ -1,10 +1,22 @@
 #include "server.hpp"
+#include "metrics/request_trace.hpp"
+#include "metrics/slow_query_log.hpp"
+#include "utils/parallel.hpp"
+#include <chrono>
 #include <iostream>
 #include <string>
 
 int main(int argc, char* argv[]) {
     std::string data_dir = "data";
     int port = 8080;
+    size_t io_threads = utils::default_parallelism();
+    bool pin_cpus = false;
+    size_t query_threads = utils::default_parallelism();
+    int query_timeout_ms = 2000;
+    bool admission = true;
+    size_t compress_min_bytes = 1024;
+    int replication_port = 0;
+    std::string replica_of;
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -13,17 +25,61 @@ int main(int argc, char* argv[]) {
             data_dir = argv[++i];
         } else if (arg == "--port" && i + 1 < argc) {
             port = std::stoi(argv[++i]);
+        } else if (arg == "--slow-ms" && i + 1 < argc) {
+            slow_log::set_threshold_us(static_cast<uint64_t>(std::stod(argv[++i]) * 1000));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            io_threads = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if (arg == "--pin-cpus") {
+            pin_cpus = true;
+        } else if (arg == "--query-threads" && i + 1 < argc) {
+            query_threads = static_cast<size_t>(std::stoi(argv[++i]));
+        } else if (arg == "--query-timeout-ms" && i + 1 < argc) {
+            query_timeout_ms = std::stoi(argv[++i]);
+        } else if (arg == "--no-admission") {
+            admission = false;
+        } else if (arg == "--compress-min-bytes" && i + 1 < argc) {
+            compress_min_bytes = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--replication-port" && i + 1 < argc) {
+            replication_port = std::stoi(argv[++i]);
+        } else if (arg == "--replica-of" && i + 1 < argc) {
+            replica_of = argv[++i];
+        } else if (arg == "--trace-requests") {
+            trace::set_enabled(true);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Usage: " << argv[0] << " [options]\n"
                       << "Options:\n"
                       << "  --data-dir <path>  Path to data directory (default: data)\n"
                       << "  --port <number>    Port to listen on (default: 8080)\n"
+                      << "  --slow-ms <ms>     Slow-query log threshold, 0 disables (default: 50)\n"
+                      << "  --threads <n>      HTTP IO threads (default: CPUs)\n"
+                      << "  --pin-cpus         Pin each IO thread and query worker to its own CPU\n"
+                      << "  --query-threads <n>      Workers for heavy queries, 0 = IO threads (default: CPUs)\n"
+                      << "  --query-timeout-ms <ms>  Deadline for heavy queries (default: 2000)\n"
+                      << "  --no-admission     Disable cost-based admission control and load shedding\n"
+                      << "  --compress-min-bytes <n> Compress larger responses on the fly, 0 disables (default: 1024)\n"
+                      << "  --replication-port <n>   Stream changes to replicas on this port (default: off)\n"
+                      << "  --replica-of <host:port> Run as a read-only replica of that primary\n"
+                      << "  --trace-requests   Add Server-Timing headers and /api/debug/timing data\n"
                       << "  --help, -h         Show this help message\n";
             return 0;
         }
     }
 
     Server server;
+    server.set_io_threads(io_threads);
+    server.set_pin_cpus(pin_cpus);
+    server.set_query_pool(query_threads, std::chrono::milliseconds(query_timeout_ms));
+    server.set_admission_enabled(admission);
+    server.set_compression_min_size(compress_min_bytes);
+    server.set_replication_port(replication_port);
+    if (!replica_of.empty()) {
+        size_t colon = replica_of.rfind(':');
+        if (colon == std::string::npos) {
+            std::cerr << "--replica-of expects host:port" << std::endl;
+            return 1;
+        }
+        server.set_replica_of(replica_of.substr(0, colon), std::stoi(replica_of.substr(colon + 1)));
+    }
     
     if (!server.initialize(data_dir)) {
         std::cerr << "Failed to initialize server" << std::endl;
@@ -0,0 +1,198 @@
+#include "metrics.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace metrics {
+
+namespace {
+
+// Per-thread slot capacity; each histogram uses kBuckets + 2 slots
+constexpr uint32_t kMaxSlots = 1 << 14;
+
+struct Shard {
+    std::atomic<uint64_t> slots[kMaxSlots] = {};
+};
+
+enum class Kind { Counter, Histogram };
+
+struct Series {
+    std::string labels;
+    uint32_t slot;
+    double scale;
+};
+
+struct Family {
+    Kind kind;
+    std::string help;
+    std::vector<Series> series;
+};
+
+// Gauges and sampled counters, read when rendering
+struct Sampled {
+    std::string name;
+    std::string help;
+    const char* type;
+    std::function<double()> sample;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, Family> families;
+    std::vector<Sampled> sampled;
+    std::vector<std::unique_ptr<Shard>> shards;
+    uint32_t next_slot = 1; // Slot 0 absorbs writes once the registry is full
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry(); // Never destroyed: threads may outlive main
+    return *instance;
+}
+
+Shard& local_shard() {
+    thread_local Shard* shard = [] {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.shards.push_back(std::make_unique<Shard>());
+        return reg.shards.back().get();
+    }();
+    return *shard;
+}
+
+// Single writer per shard, so a relaxed load/store pair is enough
+inline void add(uint32_t slot, uint64_t value) {
+    auto& cell = local_shard().slots[slot];
+    cell.store(cell.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+uint32_t bucket_for(uint64_t value) {
+    if (value <= 1) return 0;
+    uint32_t bucket = 64 - __builtin_clzll(value - 1);
+    return bucket < Histogram::kBuckets ? bucket : Histogram::kBuckets - 1;
+}
+
+uint32_t register_series(const std::string& name, const std::string& labels,
+                         const std::string& help, Kind kind, uint32_t width, double scale) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto& family = reg.families[name];
+    if (family.series.empty()) {
+        family.kind = kind;
+        family.help = help;
+    }
+    for (const auto& series : family.series) {
+        if (series.labels == labels) return series.slot;
+    }
+
+    if (reg.next_slot + width > kMaxSlots) {
+        return 0;
+    }
+    uint32_t slot = reg.next_slot;
+    reg.next_slot += width;
+    family.series.push_back({labels, slot, scale});
+    return slot;
+}
+
+uint64_t sum_slot(const Registry& reg, uint32_t slot) {
+    uint64_t total = 0;
+    for (const auto& shard : reg.shards) {
+        total += shard->slots[slot].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string with_labels(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) return "{" + extra + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+} // namespace
+
+void Counter::inc(uint64_t value) const {
+    add(slot_, value);
+}
+
+void Histogram::observe(uint64_t value) const {
+    if (slot_ == 0) return;
+    add(slot_ + bucket_for(value), 1);
+    add(slot_ + kBuckets, value);
+    add(slot_ + kBuckets + 1, 1);
+}
+
+Counter counter(const std::string& name, const std::string& labels, const std::string& help) {
+    return Counter(register_series(name, labels, help, Kind::Counter, 1, 1.0));
+}
+
+Histogram histogram(const std::string& name, const std::string& labels,
+                    const std::string& help, double scale) {
+    return Histogram(register_series(name, labels, help, Kind::Histogram,
+                                     Histogram::kBuckets + 2, scale));
+}
+
+void gauge(const std::string& name, const std::string& help, std::function<double()> sample) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.sampled.push_back({name, help, "gauge", std::move(sample)});
+}
+
+void sampled_counter(const std::string& name, const std::string& help, std::function<double()> sample) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.sampled.push_back({name, help, "counter", std::move(sample)});
+}
+
+std::string render_prometheus() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::ostringstream out;
+
+    for (const auto& series : reg.sampled) {
+        out << "# HELP " << series.name << " " << series.help << "\n"
+            << "# TYPE " << series.name << " " << series.type << "\n"
+            << series.name << " " << series.sample() << "\n";
+    }
+
+    for (const auto& [name, family] : reg.families) {
+        out << "# HELP " << name << " " << family.help << "\n";
+        if (family.kind == Kind::Counter) {
+            out << "# TYPE " << name << " counter\n";
+            for (const auto& series : family.series) {
+                out << name;
+                if (!series.labels.empty()) out << "{" << series.labels << "}";
+                out << " " << sum_slot(reg, series.slot) << "\n";
+            }
+            continue;
+        }
+
+        out << "# TYPE " << name << " histogram\n";
+        for (const auto& series : family.series) {
+            uint64_t cumulative = 0;
+            for (uint32_t i = 0; i < Histogram::kBuckets; ++i) {
+                uint64_t in_bucket = sum_slot(reg, series.slot + i);
+                cumulative += in_bucket;
+                // Skip empty leading buckets to keep the exposition short
+                if (cumulative == 0 && i + 1 < Histogram::kBuckets) continue;
+                std::ostringstream le;
+                if (i + 1 == Histogram::kBuckets) {
+                    le << "+Inf";
+                } else {
+                    le << static_cast<double>(uint64_t(1) << i) * series.scale;
+                }
+                out << name << "_bucket" << with_labels(series.labels, "le=\"" + le.str() + "\"")
+                    << " " << cumulative << "\n";
+            }
+            std::string labels = series.labels.empty() ? "" : "{" + series.labels + "}";
+            out << name << "_sum" << labels << " "
+                << static_cast<double>(sum_slot(reg, series.slot + Histogram::kBuckets)) * series.scale << "\n";
+            out << name << "_count" << labels << " "
+                << sum_slot(reg, series.slot + Histogram::kBuckets + 1) << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+} // namespace metrics
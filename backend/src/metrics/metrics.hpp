@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Process-wide metrics in Prometheus text format.
+//
+// Every thread records into its own shard of relaxed atomics, so the hot
+// path is an uncontended load/store pair. Only registering a new series
+// and rendering /api/metrics take the registry lock; rendering sums the
+// shards of all threads.
+namespace metrics {
+
+class Counter {
+public:
+    Counter() = default;
+    void inc(uint64_t value = 1) const;
+
+private:
+    friend Counter counter(const std::string&, const std::string&, const std::string&);
+    explicit Counter(uint32_t slot) : slot_(slot) {}
+    uint32_t slot_ = 0;
+};
+
+// Log2-bucketed histogram: bucket i holds values in (2^(i-1), 2^i].
+// Values are recorded as integers in the metric's base unit (microseconds,
+// bytes, counts) and scaled when rendered.
+class Histogram {
+public:
+    static constexpr uint32_t kBuckets = 32;
+
+    Histogram() = default;
+    void observe(uint64_t value) const;
+
+private:
+    friend Histogram histogram(const std::string&, const std::string&, const std::string&, double);
+    explicit Histogram(uint32_t slot) : slot_(slot) {}
+    uint32_t slot_ = 0; // kBuckets bucket slots, then sum, then count
+};
+
+// Register (or look up) a series. Labels are pre-rendered, e.g.
+// `route="/api/airports",method="GET"`. Registration takes a lock, so
+// callers keep the returned handle instead of registering per event.
+Counter counter(const std::string& name, const std::string& labels, const std::string& help);
+
+// `scale` converts recorded integers to the exported unit
+// (1e-6 for microseconds exported as seconds, 1.0 otherwise)
+Histogram histogram(const std::string& name, const std::string& labels,
+                    const std::string& help, double scale = 1.0);
+
+// Gauges are sampled when /api/metrics is rendered
+void gauge(const std::string& name, const std::string& help, std::function<double()> sample);
+
+// Counters kept elsewhere (e.g. a component's own atomics), sampled like
+// gauges but exported as monotonic counters
+void sampled_counter(const std::string& name, const std::string& help, std::function<double()> sample);
+
+// Render every registered series in Prometheus text exposition format
+std::string render_prometheus();
+
+// Times a scope and records it in microseconds
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram_.observe(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+
+private:
+    const Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace metrics
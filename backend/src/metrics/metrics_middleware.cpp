@@ -0,0 +1,125 @@
+#include "metrics_middleware.hpp"
+#include "../utils/affinity.hpp"
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct RouteSeries {
+    metrics::Histogram latency;
+    metrics::Histogram size;
+    std::unordered_map<int, metrics::Counter> requests_by_status;
+};
+
+// Handles are cached per thread so the registry lock is only taken the
+// first time a thread sees a (route, method) or status code
+RouteSeries& series_for(const std::string& route, const std::string& method) {
+    thread_local std::unordered_map<std::string, RouteSeries> cache;
+    std::string key = method + " " + route;
+    auto it = cache.find(key);
+    if (it != cache.end()) return it->second;
+
+    std::string labels = "route=\"" + route + "\",method=\"" + method + "\"";
+    RouteSeries series;
+    series.latency = metrics::histogram("flight_http_request_duration_seconds", labels,
+                                        "HTTP request latency by route", 1e-6);
+    series.size = metrics::histogram("flight_http_response_size_bytes", labels,
+                                     "HTTP response body size by route");
+    return cache.emplace(std::move(key), std::move(series)).first->second;
+}
+
+const metrics::Counter& status_counter(RouteSeries& series, const std::string& route,
+                                       const std::string& method, int status) {
+    auto it = series.requests_by_status.find(status);
+    if (it != series.requests_by_status.end()) return it->second;
+
+    std::string labels = "route=\"" + route + "\",method=\"" + method +
+                         "\",status=\"" + std::to_string(status) + "\"";
+    auto counter = metrics::counter("flight_http_requests_total", labels,
+                                    "HTTP requests by route and status code");
+    return series.requests_by_status.emplace(status, counter).first->second;
+}
+
+bool is_number(const std::string& segment) {
+    return !segment.empty() &&
+           std::all_of(segment.begin(), segment.end(),
+                       [](unsigned char c) { return std::isdigit(c) || c == '-'; });
+}
+
+} // namespace
+
+std::string MetricsMiddleware::route_label(const std::string& url) {
+    static const std::unordered_set<std::string> literals = {
+        "api", "airports", "airlines", "routes", "one-hop", "reachable", "changes",
+        "health", "system", "id", "stats", "metrics", "debug", "timing", "slow", "icao",
+        "analytics", "hubs", "country-matrix", "degree-distribution", "replication",
+        "versions", "pin", "export", "airports.csv", "airlines.csv", "routes.csv"
+    };
+
+    std::string path = url.substr(0, url.find('?'));
+    std::vector<std::string> segments;
+    size_t start = 1;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start) segments.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+
+    if (segments.empty() || segments.size() > 5 || segments[0] != "api") {
+        return "unmatched";
+    }
+
+    std::string label;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const auto& segment = segments[i];
+        if (literals.count(segment)) {
+            label += "/" + segment;
+        } else if (i >= 2 && is_number(segment)) {
+            label += "/<int>";
+        } else if ((i == 2 || (i == 3 && segments[2] == "icao")) &&
+                   (segments[1] == "airports" || segments[1] == "airlines")) {
+            label += "/<string>";
+        } else {
+            return "unmatched";
+        }
+    }
+    return label;
+}
+
+void MetricsMiddleware::before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+    // First middleware to run on a fresh Crow thread (--pin-cpus)
+    utils::pin_io_thread();
+
+    ctx.start = std::chrono::steady_clock::now();
+    slow_log::begin_request();
+    if (trace::enabled()) {
+        trace::begin(ctx.trace);
+        ctx.traced = true;
+    }
+}
+
+void MetricsMiddleware::after_handle(crow::request& req, crow::response& res, context& ctx) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - ctx.start).count();
+
+    std::string route = route_label(req.url);
+    std::string method = crow::method_name(req.method);
+
+    auto& series = series_for(route, method);
+    series.latency.observe(elapsed);
+    series.size.observe(res.body.size());
+    status_counter(series, route, method, res.code).inc();
+
+    uint64_t slow_threshold = slow_log::threshold_us();
+    if (slow_threshold > 0 && static_cast<uint64_t>(elapsed) >= slow_threshold) {
+        slow_log::record(method, route, req.raw_url, res.code, elapsed, slow_log::current_plan());
+    }
+
+    if (ctx.traced) {
+        res.set_header("Server-Timing", trace::finish(method + " " + route, ctx.trace));
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "crow.h"
+#include "metrics.hpp"
+#include "request_trace.hpp"
+#include "slow_query_log.hpp"
+#include <chrono>
+#include <string>
+
+// Records per-route request counts, status codes, latency and response size.
+// Registered first in the App so it also times work done by later middlewares.
+// With request tracing enabled it also adds a Server-Timing header, and
+// requests over the slow-query threshold are copied to the slow log.
+struct MetricsMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+        trace::RequestTrace trace;
+        bool traced = false;
+    };
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+    // Collapse a request path into its route template (e.g. "/api/airports/<string>")
+    // so that label cardinality stays bounded
+    static std::string route_label(const std::string& url);
+};
@@ -0,0 +1,196 @@
+#include "request_trace.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace trace {
+
+namespace {
+
+constexpr int kPhases = static_cast<int>(Phase::Count);
+
+std::atomic<bool> g_enabled{false};
+
+// Constant-initialized so operator new can touch it at any point of a
+// thread's life without triggering TLS initialization
+thread_local AllocCounters tl_allocs;
+thread_local RequestTrace* tl_current = nullptr;
+
+struct RouteTotals {
+    uint64_t requests = 0;
+    uint64_t total_us = 0;
+    uint64_t phase_us[kPhases] = {};
+    AllocCounters total_allocs;
+    AllocCounters phase_allocs[kPhases];
+};
+
+std::mutex g_totals_mutex;
+std::map<std::string, RouteTotals> g_totals;
+
+uint64_t micros_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+AllocCounters delta(const AllocCounters& now, const AllocCounters& then) {
+    return {now.count - then.count, now.bytes - then.bytes};
+}
+
+void append_metric(std::ostringstream& out, const char* name, uint64_t us,
+                   const AllocCounters& allocs) {
+    if (out.tellp() > 0) out << ", ";
+    out << name << ";dur=" << us / 1000.0;
+    if (alloc_tracking_available()) {
+        out << ";desc=\"" << allocs.count << " allocs, " << allocs.bytes << " B\"";
+    }
+}
+
+} // namespace
+
+const char* phase_name(Phase phase) {
+    switch (phase) {
+        case Phase::Lookup: return "lookup";
+        case Phase::Query: return "query";
+        case Phase::JsonBuild: return "json";
+        case Phase::Serialize: return "serialize";
+        case Phase::Count: break;
+    }
+    return "unknown";
+}
+
+bool enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void set_enabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool alloc_tracking_available() {
+#ifdef FLIGHT_ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocCounters thread_allocs() {
+    return tl_allocs;
+}
+
+RequestTrace* current() {
+    return tl_current;
+}
+
+void set_current(RequestTrace* trace) {
+    tl_current = trace;
+}
+
+void begin(RequestTrace& trace) {
+    trace = RequestTrace{};
+    trace.start = std::chrono::steady_clock::now();
+    trace.allocs_at_start = tl_allocs;
+    tl_current = &trace;
+}
+
+// While detached, allocs_at_start holds the allocations counted so far;
+// attach() rebases it onto the new thread's counter (modular arithmetic)
+RequestTrace* detach() {
+    RequestTrace* trace = tl_current;
+    if (trace) {
+        trace->allocs_at_start = delta(tl_allocs, trace->allocs_at_start);
+        tl_current = nullptr;
+    }
+    return trace;
+}
+
+void attach(RequestTrace* trace) {
+    if (trace) {
+        trace->allocs_at_start = delta(tl_allocs, trace->allocs_at_start);
+    }
+    tl_current = trace;
+}
+
+std::string finish(const std::string& route, const RequestTrace& trace) {
+    tl_current = nullptr;
+    uint64_t total_us = micros_since(trace.start);
+    AllocCounters total_allocs = delta(tl_allocs, trace.allocs_at_start);
+
+    {
+        std::lock_guard<std::mutex> lock(g_totals_mutex);
+        auto& totals = g_totals[route];
+        totals.requests++;
+        totals.total_us += total_us;
+        totals.total_allocs.count += total_allocs.count;
+        totals.total_allocs.bytes += total_allocs.bytes;
+        for (int i = 0; i < kPhases; ++i) {
+            totals.phase_us[i] += trace.phase_us[i];
+            totals.phase_allocs[i].count += trace.phase_allocs[i].count;
+            totals.phase_allocs[i].bytes += trace.phase_allocs[i].bytes;
+        }
+    }
+
+    std::ostringstream header;
+    for (int i = 0; i < kPhases; ++i) {
+        if (trace.phase_us[i] == 0 && trace.phase_allocs[i].count == 0) continue;
+        append_metric(header, phase_name(static_cast<Phase>(i)), trace.phase_us[i], trace.phase_allocs[i]);
+    }
+    append_metric(header, "total", total_us, total_allocs);
+    return header.str();
+}
+
+crow::json::wvalue summary_json() {
+    std::lock_guard<std::mutex> lock(g_totals_mutex);
+    crow::json::wvalue json;
+    json["enabled"] = enabled();
+    json["alloc_tracking"] = alloc_tracking_available();
+
+    std::vector<crow::json::wvalue> routes_json;
+    for (const auto& [route, totals] : g_totals) {
+        double n = static_cast<double>(totals.requests);
+        crow::json::wvalue item;
+        item["route"] = route;
+        item["requests"] = totals.requests;
+        item["avg_total_us"] = totals.total_us / n;
+        item["avg_allocs"] = totals.total_allocs.count / n;
+        item["avg_alloc_bytes"] = totals.total_allocs.bytes / n;
+        for (int i = 0; i < kPhases; ++i) {
+            crow::json::wvalue phase;
+            phase["avg_us"] = totals.phase_us[i] / n;
+            phase["avg_allocs"] = totals.phase_allocs[i].count / n;
+            phase["avg_alloc_bytes"] = totals.phase_allocs[i].bytes / n;
+            item["phases"][phase_name(static_cast<Phase>(i))] = std::move(phase);
+        }
+        routes_json.push_back(std::move(item));
+    }
+    json["routes"] = std::move(routes_json);
+    return json;
+}
+
+ScopedPhase::ScopedPhase(Phase phase) : trace_(tl_current), phase_(phase) {
+    if (trace_) {
+        start_ = std::chrono::steady_clock::now();
+        allocs_at_start_ = tl_allocs;
+    }
+}
+
+ScopedPhase::~ScopedPhase() {
+    if (!trace_) return;
+    int i = static_cast<int>(phase_);
+    trace_->phase_us[i] += micros_since(start_);
+    AllocCounters used = delta(tl_allocs, allocs_at_start_);
+    trace_->phase_allocs[i].count += used.count;
+    trace_->phase_allocs[i].bytes += used.bytes;
+}
+
+namespace detail {
+
+void count_allocation(uint64_t bytes) noexcept {
+    tl_allocs.count++;
+    tl_allocs.bytes += bytes;
+}
+
+} // namespace detail
+
+} // namespace trace
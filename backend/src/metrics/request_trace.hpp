@@ -0,0 +1,82 @@
+#pragma once
+#include "crow.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Opt-in per-request phase timing and allocation accounting.
+//
+// When enabled (flight_server --trace-requests), MetricsMiddleware installs
+// a RequestTrace for each request on the handling thread. Handlers mark
+// phases with ScopedPhase; the middleware returns the breakdown in a
+// Server-Timing header and aggregates it per route for /api/debug/timing.
+//
+// Allocation counts come from a replacement operator new that is only
+// linked in when built with -DFLIGHT_ALLOC_TRACKING=ON; otherwise only
+// durations are reported.
+namespace trace {
+
+enum class Phase { Lookup, Query, JsonBuild, Serialize, Count };
+
+const char* phase_name(Phase phase);
+
+struct AllocCounters {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+};
+
+struct RequestTrace {
+    uint64_t phase_us[static_cast<int>(Phase::Count)] = {};
+    AllocCounters phase_allocs[static_cast<int>(Phase::Count)] = {};
+    std::chrono::steady_clock::time_point start;
+    AllocCounters allocs_at_start;
+};
+
+bool enabled();
+void set_enabled(bool enabled);
+
+// True when the counting operator new is linked into this binary
+bool alloc_tracking_available();
+
+// Allocations made by the calling thread so far
+AllocCounters thread_allocs();
+
+// Trace of the request being handled on this thread, or nullptr
+RequestTrace* current();
+void set_current(RequestTrace* trace);
+
+// Begin/finish a request on the calling thread
+void begin(RequestTrace& trace);
+
+// Move the current trace to another thread: detach() where the request
+// was accepted, attach() on the thread that continues it. Allocations
+// counted so far carry over.
+RequestTrace* detach();
+void attach(RequestTrace* trace);
+std::string finish(const std::string& route, const RequestTrace& trace);
+
+// Per-route aggregates for /api/debug/timing
+crow::json::wvalue summary_json();
+
+// Times a phase of the current request; a no-op when tracing is off
+class ScopedPhase {
+public:
+    explicit ScopedPhase(Phase phase);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    RequestTrace* trace_;
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+    AllocCounters allocs_at_start_;
+};
+
+namespace detail {
+// Called from the replacement operator new
+void count_allocation(uint64_t bytes) noexcept;
+} // namespace detail
+
+} // namespace trace
@@ -0,0 +1,128 @@
+#include "slow_query_log.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace slow_log {
+
+namespace {
+
+constexpr size_t kCapacity = 256;
+
+// Plain data only, so a slot can be copied while the seqlock guards it
+struct Entry {
+    uint64_t id;
+    int64_t timestamp_ms;
+    uint64_t duration_us;
+    int status;
+    char method[8];
+    char route[64];
+    char url[192];
+    QueryPlan plan;
+};
+
+struct Slot {
+    std::atomic<uint64_t> version{0}; // Odd while a writer is copying in
+    Entry entry;
+};
+
+std::atomic<uint64_t> g_threshold_us{50000};
+std::atomic<uint64_t> g_next_id{0};
+std::array<Slot, kCapacity> g_ring;
+
+thread_local QueryPlan tl_plan;
+
+void copy_truncated(char* dest, size_t size, const std::string& src) {
+    size_t n = std::min(src.size(), size - 1);
+    std::memcpy(dest, src.data(), n);
+    dest[n] = '\0';
+}
+
+} // namespace
+
+void set_threshold_us(uint64_t threshold_us) {
+    g_threshold_us.store(threshold_us, std::memory_order_relaxed);
+}
+
+uint64_t threshold_us() {
+    return g_threshold_us.load(std::memory_order_relaxed);
+}
+
+void begin_request() {
+    tl_plan = QueryPlan{};
+}
+
+void record_plan(const QueryPlan& plan) {
+    tl_plan = plan;
+}
+
+const QueryPlan& current_plan() {
+    return tl_plan;
+}
+
+void record(const std::string& method, const std::string& route, const std::string& url,
+            int status, uint64_t duration_us, const QueryPlan& plan) {
+    uint64_t id = g_next_id.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = g_ring[id % kCapacity];
+
+    slot.version.store(2 * id + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Entry& entry = slot.entry;
+    entry.id = id;
+    entry.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    entry.duration_us = duration_us;
+    entry.status = status;
+    copy_truncated(entry.method, sizeof(entry.method), method);
+    copy_truncated(entry.route, sizeof(entry.route), route);
+    copy_truncated(entry.url, sizeof(entry.url), url);
+    entry.plan = plan;
+
+    slot.version.store(2 * id + 2, std::memory_order_release);
+}
+
+crow::json::wvalue to_json() {
+    std::vector<Entry> entries;
+    for (auto& slot : g_ring) {
+        uint64_t before = slot.version.load(std::memory_order_acquire);
+        if (before == 0 || before % 2 == 1) continue;
+        Entry copy;
+        std::memcpy(&copy, &slot.entry, sizeof(Entry));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != before) continue;
+        entries.push_back(copy);
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.id > b.id; });
+
+    crow::json::wvalue json;
+    json["threshold_ms"] = threshold_us() / 1000.0;
+    json["total_slow_requests"] = g_next_id.load(std::memory_order_relaxed);
+
+    std::vector<crow::json::wvalue> entries_json;
+    for (const auto& entry : entries) {
+        crow::json::wvalue item;
+        item["id"] = entry.id;
+        item["timestamp_ms"] = entry.timestamp_ms;
+        item["method"] = entry.method;
+        item["route"] = entry.route;
+        item["url"] = entry.url;
+        item["status"] = entry.status;
+        item["duration_ms"] = entry.duration_us / 1000.0;
+        if (entry.plan.one_hop) {
+            item["plan"]["type"] = "one_hop";
+            item["plan"]["intermediates_examined"] = entry.plan.intermediates_examined;
+            item["plan"]["edges_scanned"] = entry.plan.edges_scanned;
+            item["plan"]["results"] = entry.plan.results;
+        }
+        entries_json.push_back(std::move(item));
+    }
+    json["entries"] = std::move(entries_json);
+    return json;
+}
+
+} // namespace slow_log
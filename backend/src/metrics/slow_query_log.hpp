@@ -0,0 +1,38 @@
+#pragma once
+#include "crow.h"
+#include <cstdint>
+#include <string>
+
+// Requests slower than a configurable threshold, kept in a fixed-size
+// lock-free ring and exposed at /api/debug/slow.
+//
+// Writers claim a slot with one fetch_add and publish it under a per-slot
+// sequence counter (seqlock), so recording never blocks request threads;
+// readers skip slots that are being rewritten.
+namespace slow_log {
+
+// Work done by the query behind a request. DataStore fills this in for the
+// calling thread; the middleware attaches it to the slow-log entry.
+struct QueryPlan {
+    bool one_hop = false;
+    uint64_t intermediates_examined = 0;
+    uint64_t edges_scanned = 0;
+    uint64_t results = 0;
+};
+
+// A threshold of 0 disables the log
+void set_threshold_us(uint64_t threshold_us);
+uint64_t threshold_us();
+
+// Reset / fill / read the plan of the request running on this thread
+void begin_request();
+void record_plan(const QueryPlan& plan);
+const QueryPlan& current_plan();
+
+void record(const std::string& method, const std::string& route, const std::string& url,
+            int status, uint64_t duration_us, const QueryPlan& plan);
+
+// Newest entries first
+crow::json::wvalue to_json();
+
+} // namespace slow_log
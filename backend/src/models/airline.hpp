@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
 #include <sstream>
+#include <vector>
 #include "crow.h"
+#include "../encoding/msgpack.hpp"
+#include "../utils/csv.hpp"
 
 struct Airline {
     int id;
@@ -27,12 +30,88 @@ struct Airline {
         return json;
     }
 
+    // MessagePack map with the same keys as to_json()
+    void to_msgpack(msgpack::Writer& out) const {
+        out.map(8);
+        out.string("id");
+        out.integer(id);
+        out.string("name");
+        out.string(name);
+        out.string("alias");
+        out.string(alias);
+        out.string("iata");
+        out.string(iata);
+        out.string("icao");
+        out.string(icao);
+        out.string("callsign");
+        out.string(callsign);
+        out.string("country");
+        out.string(country);
+        out.string("active");
+        out.string(active);
+    }
+
+    // Columnar layout of a list (see encoding/msgpack.hpp)
+    static void to_msgpack_columns(const std::vector<const Airline*>& airlines, msgpack::Writer& out) {
+        size_t count = airlines.size();
+        out.map(8);
+        out.string("id");
+        out.column<int32_t>(count, [&](size_t i) { return airlines[i]->id; });
+        out.string("name");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->name; });
+        out.string("alias");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->alias; });
+        out.string("iata");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->iata; });
+        out.string("icao");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->icao; });
+        out.string("callsign");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->callsign; });
+        out.string("country");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->country; });
+        out.string("active");
+        out.strings(count, [&](size_t i) -> const std::string& { return airlines[i]->active; });
+    }
+
+    // Parse a request body or replicated change; optional fields get the
+    // same defaults as POST /api/airlines
+    static Airline from_json(const crow::json::rvalue& json) {
+        Airline airline;
+        airline.id = json["id"].i();
+        airline.name = json["name"].s();
+        airline.alias = json.has("alias") ? std::string(json["alias"].s()) : "";
+        airline.iata = json["iata"].s();
+        airline.icao = json.has("icao") ? std::string(json["icao"].s()) : "";
+        airline.callsign = json.has("callsign") ? std::string(json["callsign"].s()) : "";
+        airline.country = json.has("country") ? std::string(json["country"].s()) : "";
+        airline.active = json.has("active") ? std::string(json["active"].s()) : "Y";
+        return airline;
+    }
+
+    // One record in the data file's field order
+    void append_csv(std::string& out) const {
+        utils::csv_append(out, id);
+        out += ',';
+        utils::csv_append(out, name);
+        out += ',';
+        utils::csv_append(out, alias);
+        out += ',';
+        utils::csv_append(out, iata);
+        out += ',';
+        utils::csv_append(out, icao);
+        out += ',';
+        utils::csv_append(out, callsign);
+        out += ',';
+        utils::csv_append(out, country);
+        out += ',';
+        utils::csv_append(out, active);
+    }
+
     // Convert to CSV string
     std::string to_csv() const {
-        std::ostringstream oss;
-        oss << id << "," << name << "," << alias << "," << iata << ","
-            << icao << "," << callsign << "," << country << "," << active;
-        return oss.str();
+        std::string out;
+        append_csv(out);
+        return out;
     }
 
     static std::string csv_header() {
@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
 #include <sstream>
+#include <vector>
 #include "crow.h"
+#include "../encoding/msgpack.hpp"
+#include "../utils/csv.hpp"
 
 struct Airport {
     int id;
@@ -39,14 +42,131 @@ struct Airport {
         return json;
     }
 
+    // MessagePack map with the same keys as to_json()
+    void to_msgpack(msgpack::Writer& out) const {
+        out.map(14);
+        out.string("id");
+        out.integer(id);
+        out.string("name");
+        out.string(name);
+        out.string("city");
+        out.string(city);
+        out.string("country");
+        out.string(country);
+        out.string("iata");
+        out.string(iata);
+        out.string("icao");
+        out.string(icao);
+        out.string("latitude");
+        out.real(latitude);
+        out.string("longitude");
+        out.real(longitude);
+        out.string("altitude");
+        out.integer(altitude);
+        out.string("timezone");
+        out.real(timezone);
+        out.string("dst");
+        out.string(dst);
+        out.string("tz_database");
+        out.string(tz_database);
+        out.string("type");
+        out.string(type);
+        out.string("source");
+        out.string(source);
+    }
+
+    // Columnar layout of a list (see encoding/msgpack.hpp)
+    static void to_msgpack_columns(const std::vector<const Airport*>& airports, msgpack::Writer& out) {
+        size_t count = airports.size();
+        out.map(14);
+        out.string("id");
+        out.column<int32_t>(count, [&](size_t i) { return airports[i]->id; });
+        out.string("name");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->name; });
+        out.string("city");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->city; });
+        out.string("country");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->country; });
+        out.string("iata");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->iata; });
+        out.string("icao");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->icao; });
+        out.string("latitude");
+        out.column<double>(count, [&](size_t i) { return airports[i]->latitude; });
+        out.string("longitude");
+        out.column<double>(count, [&](size_t i) { return airports[i]->longitude; });
+        out.string("altitude");
+        out.column<int32_t>(count, [&](size_t i) { return airports[i]->altitude; });
+        out.string("timezone");
+        out.column<double>(count, [&](size_t i) { return airports[i]->timezone; });
+        out.string("dst");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->dst; });
+        out.string("tz_database");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->tz_database; });
+        out.string("type");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->type; });
+        out.string("source");
+        out.strings(count, [&](size_t i) -> const std::string& { return airports[i]->source; });
+    }
+
+    // Parse a request body or replicated change; optional fields get the
+    // same defaults as POST /api/airports
+    static Airport from_json(const crow::json::rvalue& json) {
+        Airport airport;
+        airport.id = json["id"].i();
+        airport.name = json["name"].s();
+        airport.city = json["city"].s();
+        airport.country = json["country"].s();
+        airport.iata = json["iata"].s();
+        airport.icao = json.has("icao") ? std::string(json["icao"].s()) : "";
+        airport.latitude = json["latitude"].d();
+        airport.longitude = json["longitude"].d();
+        airport.altitude = json.has("altitude") ? json["altitude"].i() : 0;
+        airport.timezone = json.has("timezone") ? json["timezone"].d() : 0.0;
+        airport.dst = json.has("dst") ? std::string(json["dst"].s()) : "U";
+        airport.tz_database = json.has("tz_database") ? std::string(json["tz_database"].s()) : "";
+        airport.type = json.has("type") ? std::string(json["type"].s()) : "airport";
+        airport.source = json.has("source") ? std::string(json["source"].s()) : "User";
+        return airport;
+    }
+
+    // One record in the data file's field order, quoted where needed so it
+    // reads back unchanged through CSVParser
+    void append_csv(std::string& out) const {
+        utils::csv_append(out, id);
+        out += ',';
+        utils::csv_append(out, name);
+        out += ',';
+        utils::csv_append(out, city);
+        out += ',';
+        utils::csv_append(out, country);
+        out += ',';
+        utils::csv_append(out, iata);
+        out += ',';
+        utils::csv_append(out, icao);
+        out += ',';
+        utils::csv_append(out, latitude);
+        out += ',';
+        utils::csv_append(out, longitude);
+        out += ',';
+        utils::csv_append(out, altitude);
+        out += ',';
+        utils::csv_append(out, timezone);
+        out += ',';
+        utils::csv_append(out, dst);
+        out += ',';
+        utils::csv_append(out, tz_database);
+        out += ',';
+        utils::csv_append(out, type);
+        out += ',';
+        utils::csv_append(out, source);
+    }
+
     // Convert to CSV string
     std::string to_csv() const {
-        std::ostringstream oss;
-        oss << id << "," << name << "," << city << "," << country << ","
-            << iata << "," << icao << "," << latitude << "," << longitude << ","
-            << altitude << "," << timezone << "," << dst << "," << tz_database << ","
-            << type << "," << source;
-        return oss.str();
+        std::string out;
+        append_csv(out);
+        return out;
     }
 
     static std::string csv_header() {
@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
 #include <sstream>
+#include <vector>
 #include "crow.h"
+#include "../encoding/msgpack.hpp"
+#include "../utils/csv.hpp"
 
 struct Route {
     std::string airline_iata;
@@ -29,14 +32,95 @@ struct Route {
         return json;
     }
 
+    // MessagePack map with the same keys as to_json()
+    void to_msgpack(msgpack::Writer& out) const {
+        out.map(9);
+        out.string("airline_iata");
+        out.string(airline_iata);
+        out.string("airline_id");
+        out.integer(airline_id);
+        out.string("source_airport_iata");
+        out.string(source_airport_iata);
+        out.string("source_airport_id");
+        out.integer(source_airport_id);
+        out.string("dest_airport_iata");
+        out.string(dest_airport_iata);
+        out.string("dest_airport_id");
+        out.integer(dest_airport_id);
+        out.string("codeshare");
+        out.string(codeshare);
+        out.string("stops");
+        out.integer(stops);
+        out.string("equipment");
+        out.string(equipment);
+    }
+
+    // Columnar layout of a list (see encoding/msgpack.hpp)
+    static void to_msgpack_columns(const std::vector<const Route*>& routes, msgpack::Writer& out) {
+        size_t count = routes.size();
+        out.map(9);
+        out.string("airline_iata");
+        out.strings(count, [&](size_t i) -> const std::string& { return routes[i]->airline_iata; });
+        out.string("airline_id");
+        out.column<int32_t>(count, [&](size_t i) { return routes[i]->airline_id; });
+        out.string("source_airport_iata");
+        out.strings(count, [&](size_t i) -> const std::string& { return routes[i]->source_airport_iata; });
+        out.string("source_airport_id");
+        out.column<int32_t>(count, [&](size_t i) { return routes[i]->source_airport_id; });
+        out.string("dest_airport_iata");
+        out.strings(count, [&](size_t i) -> const std::string& { return routes[i]->dest_airport_iata; });
+        out.string("dest_airport_id");
+        out.column<int32_t>(count, [&](size_t i) { return routes[i]->dest_airport_id; });
+        out.string("codeshare");
+        out.strings(count, [&](size_t i) -> const std::string& { return routes[i]->codeshare; });
+        out.string("stops");
+        out.column<int32_t>(count, [&](size_t i) { return routes[i]->stops; });
+        out.string("equipment");
+        out.strings(count, [&](size_t i) -> const std::string& { return routes[i]->equipment; });
+    }
+
+    // Parse a request body or replicated change; optional fields get the
+    // same defaults as POST /api/routes
+    static Route from_json(const crow::json::rvalue& json) {
+        Route route;
+        route.airline_iata = json.has("airline_iata") ? std::string(json["airline_iata"].s()) : "";
+        route.airline_id = json["airline_id"].i();
+        route.source_airport_iata = json.has("source_airport_iata") ? std::string(json["source_airport_iata"].s()) : "";
+        route.source_airport_id = json["source_airport_id"].i();
+        route.dest_airport_iata = json.has("dest_airport_iata") ? std::string(json["dest_airport_iata"].s()) : "";
+        route.dest_airport_id = json["dest_airport_id"].i();
+        route.codeshare = json.has("codeshare") ? std::string(json["codeshare"].s()) : "";
+        route.stops = json.has("stops") ? json["stops"].i() : 0;
+        route.equipment = json.has("equipment") ? std::string(json["equipment"].s()) : "";
+        return route;
+    }
+
+    // One record in the data file's field order
+    void append_csv(std::string& out) const {
+        utils::csv_append(out, airline_iata);
+        out += ',';
+        utils::csv_append(out, airline_id);
+        out += ',';
+        utils::csv_append(out, source_airport_iata);
+        out += ',';
+        utils::csv_append(out, source_airport_id);
+        out += ',';
+        utils::csv_append(out, dest_airport_iata);
+        out += ',';
+        utils::csv_append(out, dest_airport_id);
+        out += ',';
+        utils::csv_append(out, codeshare);
+        out += ',';
+        utils::csv_append(out, stops);
+        out += ',';
+        utils::csv_append(out, equipment);
+    }
+
     // Convert to CSV string
     std::string to_csv() const {
-        std::ostringstream oss;
-        oss << airline_iata << "," << airline_id << "," 
-            << source_airport_iata << "," << source_airport_id << ","
-            << dest_airport_iata << "," << dest_airport_id << "," 
-            << codeshare << "," << stops << "," << equipment;
-        return oss.str();
+        std::string out;
+        append_csv(out);
+        return out;
     }
 
     static std::string csv_header() {
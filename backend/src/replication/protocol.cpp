@@ -0,0 +1,102 @@
+#include "protocol.hpp"
+#include <cstdlib>
+#include <sys/socket.h>
+#include <cerrno>
+
+namespace replication {
+
+namespace {
+
+bool parse_op(std::string_view name, ChangeOp& op) {
+    for (ChangeOp candidate : {ChangeOp::Insert, ChangeOp::Update, ChangeOp::Delete}) {
+        if (name == to_string(candidate)) {
+            op = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_entity(std::string_view name, ChangeEntity& entity) {
+    for (ChangeEntity candidate : {ChangeEntity::Airport, ChangeEntity::Airline, ChangeEntity::Route}) {
+        if (name == to_string(candidate)) {
+            entity = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Split off the next space-terminated field
+std::string_view next_field(std::string_view& rest) {
+    size_t space = rest.find(' ');
+    std::string_view field = rest.substr(0, space);
+    rest = space == std::string_view::npos ? std::string_view() : rest.substr(space + 1);
+    return field;
+}
+
+} // namespace
+
+std::string encode_event(const ChangeEvent& event) {
+    // Keys never contain spaces and compact JSON never contains newlines
+    std::string line;
+    line.reserve(event.data.size() + 48);
+    line += event.partial ? "P " : "E ";
+    line += std::to_string(event.seq);
+    line += ' ';
+    line += to_string(event.op);
+    line += ' ';
+    line += to_string(event.entity);
+    line += ' ';
+    line += event.key;
+    line += ' ';
+    line += event.data;
+    line += '\n';
+    return line;
+}
+
+bool decode_event(std::string_view line, ChangeEvent& event) {
+    std::string_view type = next_field(line);
+    if (type != "E" && type != "P") return false;
+    event.partial = type == "P";
+    std::string seq(next_field(line));
+    if (seq.empty()) return false;
+    event.seq = std::strtoull(seq.c_str(), nullptr, 10);
+    if (!parse_op(next_field(line), event.op)) return false;
+    if (!parse_entity(next_field(line), event.entity)) return false;
+    event.key = std::string(next_field(line));
+    event.data = std::string(line);
+    return event.seq > 0 && !event.key.empty();
+}
+
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t sent = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(sent));
+    }
+    return true;
+}
+
+bool LineReader::next(std::string& line) {
+    while (true) {
+        size_t end = buffer_.find('\n', pos_);
+        if (end != std::string::npos) {
+            line.assign(buffer_, pos_, end - pos_);
+            pos_ = end + 1;
+            return true;
+        }
+
+        // Drop consumed bytes before reading more
+        buffer_.erase(0, pos_);
+        pos_ = 0;
+        char chunk[65536];
+        ssize_t received = ::recv(fd_, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        buffer_.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+} // namespace replication
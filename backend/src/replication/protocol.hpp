@@ -0,0 +1,55 @@
+#pragma once
+#include "../database/change_log.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Line protocol between a primary and its replicas over plain TCP.
+//
+// Replica -> primary, once after connecting:
+//   SYNC <epoch> <seq>            resume after change <seq>
+//   SNAPSHOT                      send the full tables first
+// Primary -> replica:
+//   SNAPSHOT <epoch> <seq> <na> <nl> <nr> <nc>
+//                                 followed by na airport, nl airline and nr
+//                                 route JSON lines, as of change <seq>, then
+//                                 nc code index lines "<index> <key> <id>"
+//                                 (index: airport_iata, airport_icao,
+//                                 airline_iata or airline_icao; key packed)
+//   E <seq> <op> <entity> <key> <data>
+//                                 one change, as in /api/changes
+//   P <seq> <op> <entity> <key> <data>
+//                                 leading part of a multi-event mutation,
+//                                 see ChangeEvent::partial
+//   H <seq>                       heartbeat with the primary's latest seq
+// Sequence numbers restart with the primary process, so each run picks a
+// random epoch. A SYNC from another epoch, or whose <seq> has fallen out
+// of the change log, is answered with a SNAPSHOT, as is a replica that
+// falls behind the change log later.
+namespace replication {
+
+// Sent when idle; replicas treat a silent primary as disconnected
+constexpr int kHeartbeatMs = 1000;
+constexpr int kPrimaryTimeoutMs = 5000;
+
+std::string encode_event(const ChangeEvent& event);
+bool decode_event(std::string_view line, ChangeEvent& event);
+
+// Blocking socket helpers; false on error or a closed peer
+bool write_all(int fd, std::string_view data);
+
+// Buffered reader that splits a socket stream into '\n'-terminated lines
+class LineReader {
+public:
+    explicit LineReader(int fd) : fd_(fd) {}
+
+    // Next line without its terminator; false on EOF, error or timeout
+    bool next(std::string& line);
+
+private:
+    int fd_;
+    std::string buffer_;
+    size_t pos_ = 0;
+};
+
+} // namespace replication
@@ -0,0 +1,27 @@
+#include "read_only_middleware.hpp"
+#include "../metrics/metrics.hpp"
+
+void ReadOnlyMiddleware::configure(const std::string& primary) {
+    enabled_ = true;
+    message_ = "Read-only replica; send writes to the primary (replicating from " + primary + ")";
+}
+
+void ReadOnlyMiddleware::before_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
+    if (!enabled_) return;
+    if (req.method == crow::HTTPMethod::GET || req.method == crow::HTTPMethod::HEAD ||
+        req.method == crow::HTTPMethod::OPTIONS) {
+        return;
+    }
+    // Pins only hold a version for local reads; they change no data
+    if (req.url.compare(0, 13, "/api/versions") == 0) return;
+
+    static const auto rejected = metrics::counter(
+        "flight_replica_writes_rejected_total", "", "Mutations refused because this server is a replica");
+    rejected.inc();
+    res.code = 405;
+    res.set_header("Allow", "GET, HEAD, OPTIONS");
+    res.body = message_;
+    res.end();
+}
+
+void ReadOnlyMiddleware::after_handle(crow::request& /*req*/, crow::response& /*res*/, context& /*ctx*/) {}
@@ -0,0 +1,23 @@
+#pragma once
+#include "crow.h"
+#include <string>
+
+// Rejects mutations on a read replica with 405 before they reach the
+// handlers; writes must go to the primary, whose changes arrive through
+// the replication stream. Reads, CORS preflights and version pins (see
+// VersionHandler) pass through.
+//
+// Registered after MetricsMiddleware so rejected writes are still counted.
+struct ReadOnlyMiddleware {
+    struct context {};
+
+    // Off (everything allowed) until configured
+    void configure(const std::string& primary);
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+private:
+    bool enabled_ = false;
+    std::string message_;
+};
@@ -0,0 +1,309 @@
+#include "replication_client.hpp"
+#include "../metrics/metrics.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr auto kMinBackoff = std::chrono::milliseconds(100);
+constexpr auto kMaxBackoff = std::chrono::milliseconds(5000);
+
+bool parse_route_key(const std::string& key, int& airline_id, int& source_id, int& dest_id) {
+    return std::sscanf(key.c_str(), "%d_%d_%d", &airline_id, &source_id, &dest_id) == 3;
+}
+
+} // namespace
+
+ReplicationClient::ReplicationClient(DataStore& store, std::string host, int port)
+    : store_(store), host_(std::move(host)), port_(port),
+      primary_(host_ + ":" + std::to_string(port)) {}
+
+ReplicationClient::~ReplicationClient() {
+    stop();
+}
+
+void ReplicationClient::start() {
+    if (running_.exchange(true)) return;
+    caught_up_at_ = std::chrono::steady_clock::now();
+    thread_ = std::thread([this]() { run(); });
+}
+
+void ReplicationClient::stop() {
+    running_ = false;
+    int fd = fd_.load();
+    if (fd >= 0) ::shutdown(fd, SHUT_RDWR);
+    if (thread_.joinable()) thread_.join();
+}
+
+bool ReplicationClient::wait_bootstrapped(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return bootstrapped_cv_.wait_for(lock, timeout, [this]() { return status_.bootstrapped; });
+}
+
+ReplicationClient::Status ReplicationClient::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status status = status_;
+    if (status.connected && status.applied_seq >= status.primary_seq) {
+        status.lag_seconds = 0;
+    } else {
+        status.lag_seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - caught_up_at_).count();
+    }
+    return status;
+}
+
+void ReplicationClient::run() {
+    auto backoff = kMinBackoff;
+    while (running_) {
+        int fd = connect_primary();
+        if (fd < 0) {
+            // Short sleeps so stop() is honoured promptly
+            auto until = std::chrono::steady_clock::now() + backoff;
+            while (running_ && std::chrono::steady_clock::now() < until) {
+                std::this_thread::sleep_for(kMinBackoff);
+            }
+            backoff = std::min(backoff * 2, kMaxBackoff);
+            continue;
+        }
+        backoff = kMinBackoff;
+
+        fd_ = fd;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.connected = true;
+        }
+        stream(fd);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_.connected = false;
+        }
+        fd_ = -1;
+        ::close(fd);
+    }
+}
+
+int ReplicationClient::connect_primary() const {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (::getaddrinfo(host_.c_str(), std::to_string(port_).c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* addr = addresses; addr; addr = addr->ai_next) {
+        fd = ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) break;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addresses);
+    if (fd < 0) return -1;
+
+    // A primary that sends nothing, not even heartbeats, is gone
+    int timeout_ms = replication::kPrimaryTimeoutMs;
+    timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+void ReplicationClient::stream(int fd) {
+    std::string hello;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (status_.bootstrapped && !resync_) {
+            hello = "SYNC " + std::to_string(epoch_) + " " + std::to_string(status_.applied_seq) + "\n";
+        } else {
+            hello = "SNAPSHOT\n";
+        }
+    }
+    if (!replication::write_all(fd, hello)) return;
+
+    partial_.clear();
+    replication::LineReader reader(fd);
+    std::string line;
+    ChangeEvent event;
+    while (running_ && reader.next(line)) {
+        if (line.compare(0, 2, "E ") == 0 || line.compare(0, 2, "P ") == 0) {
+            if (!replication::decode_event(line, event) || !apply(event)) return;
+        } else if (line.compare(0, 2, "H ") == 0) {
+            note_primary_seq(std::strtoull(line.c_str() + 2, nullptr, 10));
+        } else if (line.compare(0, 9, "SNAPSHOT ") == 0) {
+            if (!load_snapshot(line, reader)) return;
+        } else {
+            std::cerr << "Replication: unexpected line from primary " << primary_ << std::endl;
+            return;
+        }
+    }
+    if (running_) {
+        std::cerr << "Replication: lost connection to primary " << primary_ << std::endl;
+    }
+}
+
+bool ReplicationClient::load_snapshot(const std::string& header, replication::LineReader& reader) {
+    unsigned long long epoch = 0, seq = 0;
+    size_t airports = 0, airlines = 0, routes = 0, codes = 0;
+    if (std::sscanf(header.c_str(), "SNAPSHOT %llu %llu %zu %zu %zu %zu",
+                    &epoch, &seq, &airports, &airlines, &routes, &codes) != 6) {
+        return false;
+    }
+
+    StoreSnapshot snapshot;
+    snapshot.seq = seq;
+    snapshot.airports.reserve(airports);
+    snapshot.airlines.reserve(airlines);
+    snapshot.routes.reserve(routes);
+
+    std::string line;
+    for (size_t i = 0; i < airports + airlines + routes; ++i) {
+        if (!reader.next(line)) return false;
+        auto json = crow::json::load(line);
+        if (!json) return false;
+        if (i < airports) {
+            snapshot.airports.push_back(Airport::from_json(json));
+        } else if (i < airports + airlines) {
+            snapshot.airlines.push_back(Airline::from_json(json));
+        } else {
+            snapshot.routes.push_back(Route::from_json(json));
+        }
+    }
+
+    // The primary's code -> id winners, so codes resolve as they do there
+    for (size_t i = 0; i < codes; ++i) {
+        if (!reader.next(line)) return false;
+        char index[16];
+        unsigned int key = 0;
+        int id = 0;
+        if (std::sscanf(line.c_str(), "%15s %u %d", index, &key, &id) != 3) return false;
+        std::vector<std::pair<uint32_t, int>>* entries = nullptr;
+        if (std::strcmp(index, "airport_iata") == 0) entries = &snapshot.codes.airport_iata;
+        else if (std::strcmp(index, "airport_icao") == 0) entries = &snapshot.codes.airport_icao;
+        else if (std::strcmp(index, "airline_iata") == 0) entries = &snapshot.codes.airline_iata;
+        else if (std::strcmp(index, "airline_icao") == 0) entries = &snapshot.codes.airline_icao;
+        if (!entries) return false;
+        entries->emplace_back(key, id);
+    }
+
+    store_.load_snapshot(std::move(snapshot));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A new epoch restarts the primary's numbering, so what it reported
+        // before says nothing about the lag now
+        if (epoch != epoch_) status_.primary_seq = seq;
+        epoch_ = epoch;
+        resync_ = false;
+        status_.bootstrapped = true;
+        status_.applied_seq = seq;
+        status_.primary_seq = std::max<uint64_t>(status_.primary_seq, seq);
+        ++status_.snapshots_loaded;
+        if (status_.applied_seq >= status_.primary_seq) {
+            caught_up_at_ = std::chrono::steady_clock::now();
+        }
+    }
+    bootstrapped_cv_.notify_all();
+    std::cout << "Replication: loaded snapshot of " << primary_ << " at seq " << seq << std::endl;
+    return true;
+}
+
+bool ReplicationClient::apply(const ChangeEvent& event) {
+    static const auto applied = metrics::counter(
+        "flight_replication_events_applied_total", "", "Change events applied from the primary");
+    static const auto resyncs = metrics::counter(
+        "flight_replication_resyncs_total", "", "Changes that failed to apply and forced a new snapshot");
+
+    // A mutation that logged several events is replayed as the single call
+    // the primary made, once its last event arrives, so rows end up in the
+    // same order (see ChangeEvent::partial)
+    if (event.partial) {
+        partial_.push_back(event);
+        return true;
+    }
+    std::vector<ChangeEvent> parts;
+    parts.swap(partial_);
+    bool rekey = !parts.empty() && event.op == ChangeOp::Insert && event.entity == ChangeEntity::Route;
+    bool complete = parts.empty() ||
+        (parts.front().seq + parts.size() == event.seq &&
+         (event.op == ChangeOp::Delete || (rekey && parts.size() == 1)));
+
+    crow::json::rvalue json;
+    bool has_data = false;
+    if (!event.data.empty()) {
+        json = crow::json::load(event.data);
+        has_data = static_cast<bool>(json);
+    }
+
+    int id = std::atoi(event.key.c_str());
+    int airline_id = 0, source_id = 0, dest_id = 0;
+    const std::string& route_key = rekey ? parts.front().key : event.key;
+    if (event.entity == ChangeEntity::Route && !parse_route_key(route_key, airline_id, source_id, dest_id)) {
+        return false;
+    }
+
+    // The same mutations the primary ran, so the local change log, caches
+    // and indexes advance exactly as they did there
+    bool ok = false;
+    switch (event.op) {
+        case ChangeOp::Insert:
+            if (!has_data || !complete) break;
+            if (event.entity == ChangeEntity::Airport) ok = store_.insert_airport(Airport::from_json(json));
+            if (event.entity == ChangeEntity::Airline) ok = store_.insert_airline(Airline::from_json(json));
+            if (event.entity == ChangeEntity::Route) {
+                ok = rekey ? store_.modify_route(airline_id, source_id, dest_id, json)
+                           : store_.insert_route(Route::from_json(json));
+            }
+            break;
+        case ChangeOp::Update:
+            if (!has_data || !complete) break;
+            if (event.entity == ChangeEntity::Airport) ok = store_.modify_airport(id, json);
+            if (event.entity == ChangeEntity::Airline) ok = store_.modify_airline(id, json);
+            if (event.entity == ChangeEntity::Route) ok = store_.modify_route(airline_id, source_id, dest_id, json);
+            break;
+        case ChangeOp::Delete:
+            if (!complete) break;
+            if (event.entity == ChangeEntity::Airport) ok = store_.remove_airport(id);
+            if (event.entity == ChangeEntity::Airline) ok = store_.remove_airline(id);
+            if (event.entity == ChangeEntity::Route) ok = store_.remove_route(airline_id, source_id, dest_id);
+            break;
+    }
+
+    if (!ok || store_.get_change_log().current_seq() != event.seq) {
+        resyncs.inc();
+        std::cerr << "Replication: change " << event.seq << " (" << to_string(event.entity) << "."
+                  << to_string(event.op) << " " << event.key
+                  << ") did not apply cleanly; reloading snapshot" << std::endl;
+        std::lock_guard<std::mutex> lock(mutex_);
+        resync_ = true;
+        return false;
+    }
+
+    applied.inc();
+    std::lock_guard<std::mutex> lock(mutex_);
+    status_.applied_seq = event.seq;
+    if (status_.applied_seq >= status_.primary_seq) {
+        status_.primary_seq = status_.applied_seq;
+        caught_up_at_ = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+void ReplicationClient::note_primary_seq(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Heartbeats only come after this epoch's snapshot or SYNC, which reset
+    // primary_seq when the epoch changed, so the maximum is within one epoch
+    status_.primary_seq = std::max(status_.primary_seq, seq);
+    if (status_.applied_seq >= status_.primary_seq) {
+        caught_up_at_ = std::chrono::steady_clock::now();
+    }
+}
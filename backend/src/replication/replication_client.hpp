@@ -0,0 +1,65 @@
+#pragma once
+#include "protocol.hpp"
+#include "../database/data_store.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Replica side of log shipping. Connects to a primary's ReplicationServer,
+// loads its snapshot into the local DataStore, then applies every change
+// through the ordinary mutation methods, so the replica's change log,
+// caches and indexes follow the primary's sequence numbers exactly.
+// Reconnects with backoff and resumes where it left off.
+class ReplicationClient {
+public:
+    struct Status {
+        bool connected = false;
+        bool bootstrapped = false;
+        uint64_t applied_seq = 0;
+        uint64_t primary_seq = 0;     // Latest seq the primary has reported
+        double lag_seconds = 0;       // Time since the replica was last caught up
+        uint64_t snapshots_loaded = 0;
+    };
+
+    ReplicationClient(DataStore& store, std::string host, int port);
+    ~ReplicationClient();
+
+    void start();
+    void stop();
+
+    // Block until the first snapshot is loaded; false on timeout
+    bool wait_bootstrapped(std::chrono::milliseconds timeout);
+
+    const std::string& primary() const { return primary_; }
+    Status status() const;
+
+private:
+    void run();
+    int connect_primary() const;
+    // Returns when the connection drops or must be re-established
+    void stream(int fd);
+    bool load_snapshot(const std::string& header, replication::LineReader& reader);
+    bool apply(const ChangeEvent& event);
+    void note_primary_seq(uint64_t seq);
+
+    DataStore& store_;
+    std::string host_;
+    int port_;
+    std::string primary_;
+    std::atomic<bool> running_{false};
+    std::atomic<int> fd_{-1};
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable bootstrapped_cv_;
+    Status status_;
+    uint64_t epoch_ = 0;
+    bool resync_ = false;  // Ask for a snapshot on the next connection
+    std::vector<ChangeEvent> partial_;  // Only touched by the client thread
+    std::chrono::steady_clock::time_point caught_up_at_;
+};
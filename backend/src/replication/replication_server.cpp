@@ -0,0 +1,252 @@
+#include "replication_server.hpp"
+#include "protocol.hpp"
+#include "../metrics/metrics.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kBatchEvents = 1024;
+constexpr size_t kFlushBytes = 64 * 1024;
+
+// A replica that accepts nothing for this long is dropped
+constexpr int kSendTimeoutSeconds = 10;
+
+void set_timeout(int fd, int option, int milliseconds) {
+    timeval tv{milliseconds / 1000, (milliseconds % 1000) * 1000};
+    ::setsockopt(fd, SOL_SOCKET, option, &tv, sizeof(tv));
+}
+
+std::string heartbeat(uint64_t seq) {
+    return "H " + std::to_string(seq) + "\n";
+}
+
+} // namespace
+
+ReplicationServer::ReplicationServer(DataStore& store)
+    : store_(store), epoch_(std::random_device{}() | (uint64_t(std::random_device{}()) << 32)) {}
+
+ReplicationServer::~ReplicationServer() {
+    stop();
+}
+
+bool ReplicationServer::start(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Replication: cannot create socket" << std::endl;
+        return false;
+    }
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        std::cerr << "Replication: cannot listen on port " << port << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen_fd_ = fd;
+    running_ = true;
+    accept_thread_ = std::thread([this]() { accept_loop(); });
+    std::cout << "Replication: serving replicas on port " << port_ << std::endl;
+    return true;
+}
+
+void ReplicationServer::stop() {
+    if (!running_.exchange(false)) return;
+
+    // shutdown() wakes the blocked accept() and any blocked send/recv
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    if (accept_thread_.joinable()) accept_thread_.join();
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+
+    std::list<std::unique_ptr<Connection>> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& conn : connections_) ::shutdown(conn->fd, SHUT_RDWR);
+        connections.swap(connections_);
+    }
+    for (auto& conn : connections) {
+        conn->thread.join();
+        ::close(conn->fd);
+    }
+}
+
+std::vector<ReplicationServer::ReplicaInfo> ReplicationServer::replicas() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ReplicaInfo> result;
+    for (const auto& conn : connections_) {
+        if (!conn->done) result.push_back({conn->peer, conn->sent_seq});
+    }
+    return result;
+}
+
+void ReplicationServer::accept_loop() {
+    while (running_) {
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        int fd = ::accept(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        if (fd < 0) {
+            if (!running_) break;
+            if (errno != EINTR) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        reap_finished();
+
+        char ip[INET_ADDRSTRLEN] = "?";
+        ::inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->peer = std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+        Connection& ref = *conn;
+        connections_.push_back(std::move(conn));
+        ref.thread = std::thread([this, &ref]() { serve(ref); });
+    }
+}
+
+void ReplicationServer::reap_finished() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        if ((*it)->done) {
+            (*it)->thread.join();
+            ::close((*it)->fd);
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ReplicationServer::serve(Connection& conn) {
+    static const auto events_sent = metrics::counter(
+        "flight_replication_events_sent_total", "", "Change events shipped to replicas");
+    static const auto snapshots_sent = metrics::counter(
+        "flight_replication_snapshots_sent_total", "", "Full snapshots shipped to replicas");
+
+    set_timeout(conn.fd, SO_RCVTIMEO, replication::kPrimaryTimeoutMs);
+    set_timeout(conn.fd, SO_SNDTIMEO, kSendTimeoutSeconds * 1000);
+
+    // The replica says where it is; anything unexpected gets a snapshot
+    replication::LineReader reader(conn.fd);
+    std::string hello;
+    bool ok = reader.next(hello);
+    bool need_snapshot = true;
+    unsigned long long epoch = 0, since = 0;
+    if (ok && std::sscanf(hello.c_str(), "SYNC %llu %llu", &epoch, &since) == 2 &&
+        epoch == epoch_ && since <= store_.get_change_log().current_seq()) {
+        conn.sent_seq = since;
+        need_snapshot = false;
+    }
+    if (ok) {
+        std::cout << "Replication: replica " << conn.peer << " connected ("
+                  << (need_snapshot ? "snapshot" : "resume after " + std::to_string(since)) << ")"
+                  << std::endl;
+    }
+
+    const ChangeLog& log = store_.get_change_log();
+    std::vector<ChangeEvent> events;
+    std::string batch;
+    while (ok && running_) {
+        if (need_snapshot) {
+            ok = send_snapshot(conn);
+            if (ok) snapshots_sent.inc();
+            need_snapshot = false;
+            continue;
+        }
+
+        events.clear();
+        if (!log.read_since(conn.sent_seq, kBatchEvents, events)) {
+            // Fell out of the ring while this replica lagged
+            need_snapshot = true;
+            continue;
+        }
+        if (events.empty()) {
+            if (!log.wait_for(conn.sent_seq, std::chrono::milliseconds(replication::kHeartbeatMs))) {
+                ok = replication::write_all(conn.fd, heartbeat(log.current_seq()));
+            }
+            continue;
+        }
+
+        batch.clear();
+        for (const auto& event : events) batch += replication::encode_event(event);
+        batch += heartbeat(log.current_seq());
+        ok = replication::write_all(conn.fd, batch);
+        if (ok) {
+            conn.sent_seq = events.back().seq;
+            events_sent.inc(events.size());
+        }
+    }
+
+    std::cout << "Replication: replica " << conn.peer << " disconnected" << std::endl;
+    conn.done = true;
+}
+
+bool ReplicationServer::send_snapshot(Connection& conn) {
+    StoreSnapshot snapshot = store_.snapshot();
+    const std::pair<const char*, const std::vector<std::pair<uint32_t, int>>*> code_maps[] = {
+        {"airport_iata", &snapshot.codes.airport_iata},
+        {"airport_icao", &snapshot.codes.airport_icao},
+        {"airline_iata", &snapshot.codes.airline_iata},
+        {"airline_icao", &snapshot.codes.airline_icao},
+    };
+    size_t codes = 0;
+    for (const auto& [name, entries] : code_maps) codes += entries->size();
+
+    std::string buffer = "SNAPSHOT " + std::to_string(epoch_) + " " + std::to_string(snapshot.seq) +
+                         " " + std::to_string(snapshot.airports.size()) +
+                         " " + std::to_string(snapshot.airlines.size()) +
+                         " " + std::to_string(snapshot.routes.size()) +
+                         " " + std::to_string(codes) + "\n";
+    auto flush = [&]() {
+        if (buffer.size() < kFlushBytes) return true;
+        bool sent = replication::write_all(conn.fd, buffer);
+        buffer.clear();
+        return sent;
+    };
+
+    auto append = [&](const crow::json::wvalue& json) {
+        buffer += json.dump();
+        buffer += '\n';
+        return flush();
+    };
+
+    for (const auto& airport : snapshot.airports) {
+        if (!append(airport.to_json())) return false;
+    }
+    for (const auto& airline : snapshot.airlines) {
+        if (!append(airline.to_json())) return false;
+    }
+    for (const auto& route : snapshot.routes) {
+        if (!append(route.to_json())) return false;
+    }
+    for (const auto& [name, entries] : code_maps) {
+        for (const auto& [key, id] : *entries) {
+            buffer += name;
+            buffer += ' ' + std::to_string(key) + ' ' + std::to_string(id) + '\n';
+            if (!flush()) return false;
+        }
+    }
+    if (!replication::write_all(conn.fd, buffer)) return false;
+
+    conn.sent_seq = snapshot.seq;
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "../database/data_store.hpp"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Primary side of log shipping. Listens on its own TCP port and gives each
+// connected replica a thread that sends a snapshot if needed, then tails
+// the DataStore's change log (see protocol.hpp). A replica that stops
+// reading is dropped and resyncs when it reconnects.
+class ReplicationServer {
+public:
+    struct ReplicaInfo {
+        std::string peer;
+        uint64_t sent_seq;
+    };
+
+    explicit ReplicationServer(DataStore& store);
+    ~ReplicationServer();
+
+    // Binds 0.0.0.0:port (0 picks a free port, see port()); false if the
+    // port cannot be bound
+    bool start(int port);
+    void stop();
+
+    int port() const { return port_; }
+    std::vector<ReplicaInfo> replicas() const;
+
+private:
+    struct Connection {
+        int fd;
+        std::string peer;
+        std::atomic<uint64_t> sent_seq{0};
+        std::atomic<bool> done{false};
+        std::thread thread;
+    };
+
+    void accept_loop();
+    void serve(Connection& conn);
+    bool send_snapshot(Connection& conn);
+    void reap_finished();
+
+    DataStore& store_;
+    uint64_t epoch_;
+    int port_ = 0;
+    int listen_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+
+    mutable std::mutex mutex_;
+    std::list<std::unique_ptr<Connection>> connections_;
+};
@@ -1,21 +1,61 @@
 #include "server.hpp"
 #include "handlers/airline_handler.hpp"
 #include "handlers/airport_handler.hpp"
+#include "handlers/analytics_handler.hpp"
+#include "handlers/change_handler.hpp"
+#include "handlers/export_handler.hpp"
+#include "handlers/query_offload.hpp"
 #include "handlers/route_handler.hpp"
+#include "handlers/version_handler.hpp"
+#include "metrics/metrics.hpp"
+#include "metrics/request_trace.hpp"
+#include "metrics/slow_query_log.hpp"
+#include "utils/affinity.hpp"
+#include "utils/parallel.hpp"
 #include <iostream>
+#include <optional>
 
-Server::Server() : app_() {}
+Server::Server()
+    : app_(), centrality_job_(store_),
+      io_threads_(utils::default_parallelism()),
+      query_threads_(utils::default_parallelism()) {}
+
+void Server::set_query_pool(size_t threads, std::chrono::milliseconds timeout) {
+    query_threads_ = threads;
+    query_timeout_ = timeout;
+}
 
 bool Server::initialize(const std::string& data_dir) {
     std::string airports_path = data_dir + "/airports.csv";
     std::string airlines_path = data_dir + "/airlines.csv";
     std::string routes_path = data_dir + "/routes.csv";
 
-    std::cout << "Loading data from: " << data_dir << std::endl;
-    
-    if (!store_.load_data(airports_path, airlines_path, routes_path)) {
-        std::cerr << "Failed to load data files" << std::endl;
-        return false;
+    if (!primary_host_.empty()) {
+        // Replicas serve reads only; the primary's snapshot replaces the CSVs
+        app_.get_middleware<ReadOnlyMiddleware>().configure(
+            primary_host_ + ":" + std::to_string(primary_port_));
+        replication_client_ = std::make_unique<ReplicationClient>(store_, primary_host_, primary_port_);
+        replication_client_->start();
+        std::cout << "Waiting for snapshot from primary " << replication_client_->primary() << std::endl;
+        while (!replication_client_->wait_bootstrapped(std::chrono::seconds(5))) {
+            std::cout << "Still waiting for primary " << replication_client_->primary() << std::endl;
+        }
+    } else {
+        std::cout << "Loading data from: " << data_dir << std::endl;
+
+        if (!store_.load_data(airports_path, airlines_path, routes_path)) {
+            std::cerr << "Failed to load data files" << std::endl;
+            return false;
+        }
+    }
+
+    // Replicas may serve further replicas; their sequence numbers follow
+    // the primary's
+    if (replication_port_ > 0) {
+        replication_server_ = std::make_unique<ReplicationServer>(store_);
+        if (!replication_server_->start(replication_port_)) {
+            return false;
+        }
     }
 
     // Enable CORS for frontend development
@@ -25,10 +65,34 @@ bool Server::initialize(const std::string& data_dir) {
         .methods("GET"_method, "POST"_method, "PATCH"_method, "DELETE"_method, "OPTIONS"_method)
         .headers("Content-Type", "Accept");
 
+    // Shed expensive requests before they saturate the workers
+    if (admission_enabled_) {
+        app_.get_middleware<AdmissionMiddleware>().configure(store_, AdmissionMiddleware::Limits());
+    }
+
+    // Full list bodies are precompressed per version in their handlers
+    if (compression_min_size_ > 0) {
+        app_.get_middleware<CompressionMiddleware>().configure(compression_min_size_, 6);
+    }
+
+    // Heavy queries run on their own pool, off the IO threads
+    // With --pin-cpus IO threads take the first CPUs and query workers the
+    // ones after them
+    if (query_threads_ > 0) {
+        std::optional<size_t> first_cpu;
+        if (pin_cpus_) first_cpu = io_threads_;
+        query_executor_ = std::make_unique<utils::Executor>(query_threads_, first_cpu);
+    }
+    offload::configure(query_executor_.get(), query_timeout_);
+
     // Register all route handlers
     AirlineHandler::register_routes(app_, store_);
     AirportHandler::register_routes(app_, store_);
     RouteHandler::register_routes(app_, store_);
+    ChangeHandler::register_routes(app_, store_);
+    AnalyticsHandler::register_routes(app_, store_);
+    VersionHandler::register_routes(app_, store_);
+    ExportHandler::register_routes(app_, store_);
 
     // Health check endpoint
     CROW_ROUTE(app_, "/api/health")
@@ -39,6 +103,114 @@ bool Server::initialize(const std::string& data_dir) {
         return crow::response(200, json);
     });
 
+    // Prometheus metrics endpoint
+    metrics::gauge("flight_airports", "Airports in the data store",
+                   [this]() { return static_cast<double>(store_.get_airport_count()); });
+    metrics::gauge("flight_airlines", "Airlines in the data store",
+                   [this]() { return static_cast<double>(store_.get_airline_count()); });
+    metrics::gauge("flight_routes", "Routes in the data store",
+                   [this]() { return static_cast<double>(store_.get_route_count()); });
+    metrics::gauge("flight_change_seq", "Sequence number of the latest mutation",
+                   [this]() { return static_cast<double>(store_.get_change_log().current_seq()); });
+    metrics::gauge("flight_one_hop_cache_entries", "One-hop results currently cached",
+                   [this]() { return static_cast<double>(store_.get_one_hop_cache_stats().entries); });
+    metrics::sampled_counter("flight_one_hop_cache_hits_total", "One-hop cache hits",
+                             [this]() { return static_cast<double>(store_.get_one_hop_cache_stats().hits); });
+    metrics::sampled_counter("flight_one_hop_cache_misses_total", "One-hop cache misses",
+                             [this]() { return static_cast<double>(store_.get_one_hop_cache_stats().misses); });
+    metrics::sampled_counter("flight_one_hop_cache_evictions_total", "One-hop results evicted for capacity",
+                             [this]() { return static_cast<double>(store_.get_one_hop_cache_stats().evictions); });
+    metrics::sampled_counter("flight_one_hop_cache_invalidations_total", "One-hop results evicted by mutations",
+                             [this]() {
+                                 return static_cast<double>(store_.get_one_hop_cache_stats().invalidations);
+                             });
+    metrics::gauge("flight_centrality_lag", "Mutations not yet reflected in airport centrality",
+                   [this]() {
+                       auto scores = store_.get_centrality();
+                       const ChangeLog& log = store_.get_change_log();
+                       uint64_t seq = log.current_seq();
+                       bool current = scores && scores->generation == log.generation();
+                       return static_cast<double>(current ? seq - scores->version : seq);
+                   });
+    metrics::gauge("flight_retained_versions", "Old versions held in memory for as-of reads",
+                   [this]() { return static_cast<double>(store_.retained_versions()); });
+
+    metrics::gauge("flight_replication_lag_events", "Primary changes not yet applied on this replica",
+                   [this]() {
+                       if (!replication_client_) return 0.0;
+                       auto status = replication_client_->status();
+                       return static_cast<double>(status.primary_seq - status.applied_seq);
+                   });
+    metrics::gauge("flight_replication_lag_seconds", "Seconds since this replica was last caught up",
+                   [this]() {
+                       return replication_client_ ? replication_client_->status().lag_seconds : 0.0;
+                   });
+    metrics::gauge("flight_replication_replicas", "Replicas connected to this server",
+                   [this]() {
+                       return static_cast<double>(replication_server_ ? replication_server_->replicas().size() : 0);
+                   });
+
+    metrics::gauge("flight_query_queued", "Offloaded queries waiting for a worker",
+                   [this]() {
+                       return static_cast<double>(query_executor_ ? query_executor_->queued() : 0);
+                   });
+
+    // Airport centrality is recomputed in the background after route changes
+    centrality_job_.start();
+
+    CROW_ROUTE(app_, "/api/metrics")
+    ([]() {
+        crow::response res(200, metrics::render_prometheus());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
+    // Replication role, lag and connected replicas
+    CROW_ROUTE(app_, "/api/replication")
+    ([this]() {
+        crow::json::wvalue json;
+        uint64_t current_seq = store_.get_change_log().current_seq();
+        json["role"] = replication_client_ ? "replica" : replication_server_ ? "primary" : "standalone";
+        json["current_seq"] = current_seq;
+
+        if (replication_client_) {
+            auto status = replication_client_->status();
+            json["primary"] = replication_client_->primary();
+            json["connected"] = status.connected;
+            json["applied_seq"] = status.applied_seq;
+            json["primary_seq"] = status.primary_seq;
+            json["lag_events"] = status.primary_seq - status.applied_seq;
+            json["lag_seconds"] = status.lag_seconds;
+            json["snapshots_loaded"] = status.snapshots_loaded;
+        }
+
+        if (replication_server_) {
+            std::vector<crow::json::wvalue> replicas_json;
+            for (const auto& replica : replication_server_->replicas()) {
+                crow::json::wvalue item;
+                item["peer"] = replica.peer;
+                item["sent_seq"] = replica.sent_seq;
+                item["lag_events"] = current_seq - std::min(current_seq, replica.sent_seq);
+                replicas_json.push_back(std::move(item));
+            }
+            json["replication_port"] = replication_server_->port();
+            json["replicas"] = std::move(replicas_json);
+        }
+        return crow::response(200, json);
+    });
+
+    // Per-route phase timing and allocation aggregates (--trace-requests)
+    CROW_ROUTE(app_, "/api/debug/timing")
+    ([]() {
+        return crow::response(200, trace::summary_json());
+    });
+
+    // Requests over the slow-query threshold (--slow-ms), newest first
+    CROW_ROUTE(app_, "/api/debug/slow")
+    ([]() {
+        return crow::response(200, slow_log::to_json());
+    });
+
     std::cout << "Server initialized successfully" << std::endl;
     return true;
 }
@@ -47,24 +219,50 @@ void Server::run(int port) {
     std::cout << "Starting server on port " << port << std::endl;
     std::cout << "API Documentation:" << std::endl;
     std::cout << "  GET    /api/airlines/<iata>                - Get airline by IATA" << std::endl;
+    std::cout << "  GET    /api/airlines/icao/<icao>           - Get airline by ICAO" << std::endl;
     std::cout << "  GET    /api/airlines/<iata>/airports       - Get airports served by airline" << std::endl;
     std::cout << "  GET    /api/airlines                       - Get all airlines sorted by IATA" << std::endl;
     std::cout << "  GET    /api/airports/<iata>                - Get airport by IATA" << std::endl;
+    std::cout << "  GET    /api/airports/icao/<icao>           - Get airport by ICAO" << std::endl;
     std::cout << "  GET    /api/airports/<iata>/airlines       - Get airlines serving airport" << std::endl;
     std::cout << "  GET    /api/airports                       - Get all airports sorted by IATA" << std::endl;
+    std::cout << "  GET    /api/routes?airline=&source=&dest=&stops=&equipment=&codeshare= - Filter routes" << std::endl;
     std::cout << "  GET    /api/routes/one-hop?source=X&dest=Y - Find one-hop routes" << std::endl;
+    std::cout << "  GET    /api/routes/reachable?source=X&dest=Y - Reachability and minimum legs" << std::endl;
     std::cout << "  GET    /api/system/id                      - Get system ID" << std::endl;
+    std::cout << "  GET    /api/analytics/hubs?by=routes|pagerank|betweenness - Ranked hub airports" << std::endl;
+    std::cout << "  GET    /api/analytics/country-matrix       - Route counts between countries" << std::endl;
+    std::cout << "  GET    /api/analytics/degree-distribution  - Airports per destination count" << std::endl;
+    std::cout << "  GET    /api/analytics/airlines?limit=N     - Airline network sizes" << std::endl;
+    std::cout << "  GET    /api/export/airports.csv            - Export all airports as CSV" << std::endl;
+    std::cout << "  GET    /api/export/airlines.csv            - Export all airlines as CSV" << std::endl;
+    std::cout << "  GET    /api/export/routes.csv              - Export all routes as CSV" << std::endl;
     std::cout << "  GET    /api/stats                          - Get database statistics" << std::endl;
+    std::cout << "  GET    /api/changes?since=N                - Change feed (JSON long-poll or SSE)" << std::endl;
+    std::cout << "  GET    /api/versions                       - Current version and pins (reads take ?as_of=<version>)" << std::endl;
+    std::cout << "  GET    /api/metrics                        - Prometheus metrics" << std::endl;
+    std::cout << "  GET    /api/replication                    - Replication role and lag" << std::endl;
+    std::cout << "  GET    /api/debug/timing                   - Per-route phase timing" << std::endl;
+    std::cout << "  GET    /api/debug/slow                     - Slow-query log" << std::endl;
     std::cout << "  POST   /api/airlines                       - Insert airline" << std::endl;
     std::cout << "  POST   /api/airports                       - Insert airport" << std::endl;
     std::cout << "  POST   /api/routes                         - Insert route" << std::endl;
+    std::cout << "  POST   /api/versions/pin?ttl=<seconds>     - Pin the current version for as-of reads" << std::endl;
     std::cout << "  PATCH  /api/airlines/<id>                  - Modify airline" << std::endl;
     std::cout << "  PATCH  /api/airports/<id>                  - Modify airport" << std::endl;
     std::cout << "  PATCH  /api/routes/<aid>/<sid>/<did>       - Modify route" << std::endl;
     std::cout << "  DELETE /api/airlines/<id>                  - Delete airline" << std::endl;
     std::cout << "  DELETE /api/airports/<id>                  - Delete airport" << std::endl;
     std::cout << "  DELETE /api/routes/<aid>/<sid>/<did>       - Delete route" << std::endl;
+    std::cout << "  DELETE /api/versions/pin/<id>              - Release a pinned version" << std::endl;
     std::cout << std::endl;
     
-    app_.port(port).multithreaded().run();
+    if (pin_cpus_) {
+        utils::enable_io_thread_pinning(0);
+        std::cout << "Pinning " << io_threads_ << " IO threads and " << query_threads_
+                  << " query workers across " << utils::available_cpus() << " CPUs" << std::endl;
+    }
+
+    // Crow keeps one of its threads for accepting connections and timers
+    app_.port(port).concurrency(static_cast<uint16_t>(io_threads_ + 1)).run();
 }
\ No newline at end of file
@@ -1,15 +1,62 @@
 #pragma once
-#include "crow.h"
-#include "crow/middlewares/cors.h"
+#include "app.hpp"
+#include "database/centrality_job.hpp"
 #include "database/data_store.hpp"
+#include "replication/replication_client.hpp"
+#include "replication/replication_server.hpp"
+#include "utils/executor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
 class Server {
 public:
     Server();
     bool initialize(const std::string& data_dir);
+
+    // Worker threads for heavy queries (0 runs them on the IO threads) and
+    // their default deadline; takes effect in initialize()
+    void set_query_pool(size_t threads, std::chrono::milliseconds timeout);
+
+    // HTTP IO threads (default: one per CPU), and whether to pin them and
+    // the query workers to distinct CPUs; take effect in initialize()/run()
+    void set_io_threads(size_t threads) { io_threads_ = std::max<size_t>(1, threads); }
+    void set_pin_cpus(bool pin) { pin_cpus_ = pin; }
+
+    // Cost-based admission control (on by default)
+    void set_admission_enabled(bool enabled) { admission_enabled_ = enabled; }
+
+    // Bodies at least this large are gzip/deflate-compressed on the fly
+    // when the client accepts it; 0 disables on-the-fly compression
+    void set_compression_min_size(size_t bytes) { compression_min_size_ = bytes; }
+
+    // Ship the change stream to replicas connecting on this port (0 = off)
+    void set_replication_port(int port) { replication_port_ = port; }
+
+    // Run as a read-only replica of the primary at host:port: data comes
+    // from its snapshot and change stream instead of the CSV files
+    void set_replica_of(const std::string& host, int port) {
+        primary_host_ = host;
+        primary_port_ = port;
+    }
     void run(int port = 8080);
 
 private:
-    crow::App<crow::CORSHandler> app_;
+    FlightApp app_;
     DataStore store_;
+    CentralityJob centrality_job_;
+
+    size_t io_threads_;
+    bool pin_cpus_ = false;
+    size_t query_threads_;
+    std::chrono::milliseconds query_timeout_{2000};
+    std::unique_ptr<utils::Executor> query_executor_;
+    bool admission_enabled_ = true;
+    size_t compression_min_size_ = 1024;
+
+    int replication_port_ = 0;
+    std::string primary_host_;
+    int primary_port_ = 0;
+    std::unique_ptr<ReplicationServer> replication_server_;
+    std::unique_ptr<ReplicationClient> replication_client_;
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "affinity.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+std::atomic<bool> g_io_pinning{false};
+std::atomic<size_t> g_next_io_cpu{0};
+
+// CPU ids the process was allowed to use before anything was pinned.
+// Read once, so a pinned thread still sees the full set.
+const std::vector<int>& allowed_cpus() {
+    static const std::vector<int> cpus = [] {
+        std::vector<int> ids;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) ids.push_back(cpu);
+            }
+        }
+#endif
+        return ids;
+    }();
+    return cpus;
+}
+
+} // namespace
+
+size_t available_cpus() {
+    const auto& cpus = allowed_cpus();
+    return cpus.empty() ? std::max(1u, std::thread::hardware_concurrency()) : cpus.size();
+}
+
+bool pin_current_thread(size_t index) {
+    const auto& cpus = allowed_cpus();
+    if (cpus.empty()) return false;
+#ifdef __linux__
+    cpu_set_t target;
+    CPU_ZERO(&target);
+    CPU_SET(cpus[index % cpus.size()], &target);
+    return pthread_setaffinity_np(pthread_self(), sizeof(target), &target) == 0;
+#else
+    return false;
+#endif
+}
+
+void enable_io_thread_pinning(size_t first) {
+    allowed_cpus();  // Capture the mask before any thread narrows its own
+    g_next_io_cpu.store(first);
+    g_io_pinning.store(true);
+}
+
+void pin_io_thread() {
+    thread_local bool pinned = false;
+    if (pinned || !g_io_pinning.load(std::memory_order_relaxed)) return;
+    pinned = true;
+    pin_current_thread(g_next_io_cpu.fetch_add(1));
+}
+
+} // namespace utils
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+// CPU pinning for the server's long-lived threads (--pin-cpus).
+//
+// CPUs are numbered by their position in the process affinity mask, so
+// pinning stays inside whatever set taskset/cgroups allow; indexes past
+// the end wrap around. Pinning is a no-op returning false off Linux.
+namespace utils {
+
+// CPUs this process may run on
+size_t available_cpus();
+
+// Restrict the calling thread to the index-th available CPU
+bool pin_current_thread(size_t index);
+
+// Threads created by Crow cannot be pinned at start-up, so each one pins
+// itself on its first request. They take consecutive CPUs from `first`;
+// until this is called pin_io_thread() does nothing.
+void enable_io_thread_pinning(size_t first);
+void pin_io_thread();
+
+} // namespace utils
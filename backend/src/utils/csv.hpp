@@ -0,0 +1,96 @@
+#pragma once
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// RFC 4180 fields: values containing a comma, quote or line break are
+// wrapped in double quotes, with embedded quotes doubled. Records written
+// with csv_append() read back unchanged through csv_split().
+namespace utils {
+
+// Append one field. Values with leading or trailing whitespace are quoted
+// too, since csv_split() trims unquoted fields.
+inline void csv_append(std::string& out, std::string_view value) {
+    bool quote = !value.empty() && (std::isspace(static_cast<unsigned char>(value.front())) ||
+                                    std::isspace(static_cast<unsigned char>(value.back())));
+    for (char c : value) {
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+// Integers and doubles via to_chars; doubles use the shortest form that
+// parses back to the same value
+inline void csv_append(std::string& out, int value) {
+    char buf[16];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+inline void csv_append(std::string& out, double value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+// Split one record into `fields`. Unquoted fields are trimmed; quoted
+// ones are kept exactly. False if a quoted field is still open at the
+// end of `record`: it continues on the next line, so append "\n" and the
+// next line and call again.
+inline bool csv_split(std::string_view record, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t pos = 0;
+    while (true) {
+        // Skip whitespace before the field
+        while (pos < record.size() && record[pos] != ',' &&
+               std::isspace(static_cast<unsigned char>(record[pos]))) {
+            ++pos;
+        }
+
+        std::string field;
+        if (pos < record.size() && record[pos] == '"') {
+            ++pos;
+            while (true) {
+                if (pos >= record.size()) return false;
+                char c = record[pos++];
+                if (c != '"') {
+                    field += c;
+                } else if (pos < record.size() && record[pos] == '"') {
+                    field += '"';
+                    ++pos;
+                } else {
+                    break;
+                }
+            }
+            // Anything between the closing quote and the comma is dropped
+            while (pos < record.size() && record[pos] != ',') ++pos;
+        } else {
+            size_t end = record.find(',', pos);
+            if (end == std::string_view::npos) end = record.size();
+            size_t last = end;
+            while (last > pos && std::isspace(static_cast<unsigned char>(record[last - 1]))) --last;
+            field.assign(record.substr(pos, last - pos));
+            pos = end;
+        }
+        fields.push_back(std::move(field));
+
+        if (pos >= record.size()) return true;
+        ++pos;  // Comma
+    }
+}
+
+} // namespace utils
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace utils {
+
+// Time budget and cancellation flag of one query. Long-running queries
+// poll expired() between units of work and stop early; whoever owns the
+// request may cancel() it from another thread, or give it a probe that
+// expired() consults every few polls (e.g. whether the client is still
+// connected).
+class Deadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // No time limit; only cancel() ends it
+    Deadline() : at_(Clock::time_point::max()) {}
+    explicit Deadline(Clock::duration budget) : at_(Clock::now() + budget) {}
+
+    bool expired() const {
+        if (cancelled_.load(std::memory_order_relaxed)) return true;
+        if (probe_ && polls_.fetch_add(1, std::memory_order_relaxed) % kProbeEvery == 0 && !probe_()) {
+            cancelled_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return Clock::now() >= at_;
+    }
+
+    // `alive` returning false cancels; set before the query starts polling
+    void set_probe(std::function<bool()> alive) { probe_ = std::move(alive); }
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t kProbeEvery = 64;
+
+    Clock::time_point at_;
+    mutable std::atomic<bool> cancelled_{false};
+    std::function<bool()> probe_;
+    mutable std::atomic<uint32_t> polls_{0};
+};
+
+} // namespace utils
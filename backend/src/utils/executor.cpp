@@ -0,0 +1,101 @@
+#include "executor.hpp"
+#include "affinity.hpp"
+#include <algorithm>
+
+namespace utils {
+
+namespace {
+
+// Pool and queue of the worker running on this thread, if any
+thread_local const Executor* tl_executor = nullptr;
+thread_local size_t tl_queue = 0;
+
+} // namespace
+
+Executor::Executor(size_t workers, std::optional<size_t> first_cpu) {
+    workers = std::max<size_t>(1, workers);
+    for (size_t i = 0; i < workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i, first_cpu]() {
+            if (first_cpu) pin_current_thread(*first_cpu + i);
+            run(i);
+        });
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void Executor::submit(Task task) {
+    size_t index = tl_executor == this
+        ? tl_queue
+        : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_relaxed);
+
+    // Taking the lock orders this wake-up after any worker's idle check
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+bool Executor::try_pop(size_t index, Task& task) {
+    {
+        auto& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::run(size_t index) {
+    tl_executor = this;
+    tl_queue = index;
+
+    Task task;
+    while (true) {
+        if (try_pop(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this]() {
+            return stopping_ || queued_.load(std::memory_order_relaxed) > 0;
+        });
+        if (stopping_ && queued_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace utils
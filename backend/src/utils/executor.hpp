@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// Fixed pool of worker threads for long-running queries, kept apart from
+// the HTTP IO threads.
+//
+// Each worker owns a task deque. A worker pops its own deque newest-first
+// and, when that runs dry, steals the oldest task from another worker.
+// Tasks submitted from outside the pool are dealt round-robin; tasks
+// submitted by a worker go to its own deque.
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    // With `first_cpu`, worker i is pinned to available CPU first_cpu + i
+    // (see affinity.hpp)
+    explicit Executor(size_t workers, std::optional<size_t> first_cpu = std::nullopt);
+    ~Executor();  // Runs whatever is still queued, then joins
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void submit(Task task);
+
+    size_t workers() const { return threads_.size(); }
+    size_t queued() const { return queued_.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(size_t index);
+    bool try_pop(size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> queued_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+} // namespace utils
@@ -0,0 +1,67 @@
+#pragma once
+#include "executor.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// Worker count for CPU-bound batch jobs
+inline size_t default_parallelism() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Split [0, n) into `chunks` contiguous ranges and call fn(chunk, begin, end)
+// for each one on its own thread. Chunk 0 runs on the calling thread.
+// Returns the number of chunks actually used (never more than n).
+template <typename Fn>
+size_t parallel_chunks(size_t n, size_t chunks, Fn fn) {
+    chunks = std::max<size_t>(1, std::min(chunks, n));
+    size_t per_chunk = (n + chunks - 1) / std::max<size_t>(chunks, 1);
+
+    std::vector<std::thread> threads;
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = std::min(n, c * per_chunk);
+        size_t end = std::min(n, begin + per_chunk);
+        threads.emplace_back([&fn, c, begin, end]() { fn(c, begin, end); });
+    }
+    fn(size_t(0), size_t(0), std::min(n, per_chunk));
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return chunks;
+}
+
+// As above, but chunks 1.. run as tasks on `pool` rather than on threads
+// started for the call, for jobs that split work many times over (one
+// split per solver iteration). Must not be called from one of `pool`'s
+// own workers, which would wait on tasks queued behind it.
+template <typename Fn>
+size_t parallel_chunks(Executor& pool, size_t n, size_t chunks, Fn fn) {
+    chunks = std::max<size_t>(1, std::min(chunks, n));
+    size_t per_chunk = (n + chunks - 1) / std::max<size_t>(chunks, 1);
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t pending = chunks - 1;
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = std::min(n, c * per_chunk);
+        size_t end = std::min(n, begin + per_chunk);
+        pool.submit([&, c, begin, end]() {
+            fn(c, begin, end);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        });
+    }
+    fn(size_t(0), size_t(0), std::min(n, per_chunk));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]() { return pending == 0; });
+    return chunks;
+}
+
+} // namespace utils
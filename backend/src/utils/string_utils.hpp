@@ -38,6 +38,13 @@ inline std::string to_upper(const std::string& str) {
     return result;
 }
 
+// Convert string to lowercase
+inline std::string to_lower(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
 // Check if string represents null value in OpenFlights data
 inline bool is_null(const std::string& str) {
     return str == "\\N" || str.empty();
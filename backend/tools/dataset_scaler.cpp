@@ -0,0 +1,308 @@
+// Synthetic OpenFlights-shaped dataset generator.
+//
+// Produces airports.csv, airlines.csv and routes.csv at `scale` times the
+// size of the seed data set, in the same format CSVParser reads:
+//
+//   flight_datagen --seed-dir data --out-dir data_x10 --scale 10
+//   flight_server --data-dir data_x10
+//
+// The shape of the seed data is preserved rather than its contents:
+//   - Airports are scattered around seed airports (Gaussian jitter), so
+//     they inherit country, timezone and geographic clustering.
+//   - Airport popularity follows a Pareto (power-law) distribution, and
+//     each airline concentrates its routes on a few hubs in its home
+//     country, which yields hub-and-spoke degree distributions.
+//   - Most routes are domestic/regional and most are flown in both
+//     directions, as in the real network.
+#include "database/csv_parser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+struct Config {
+    std::string seed_dir = "data";
+    std::string out_dir = ".";
+    double scale = 10.0;
+    uint32_t random_seed = 42;
+};
+
+// Real counts: ~7.7k airports, ~6.2k airlines, ~67k routes
+constexpr double kRoutesPerAirport = 67663.0 / 7698.0;
+constexpr double kAirlinesPerAirport = 6162.0 / 7698.0;
+constexpr double kActiveAirlineFraction = 0.2;
+constexpr double kHubRouteFraction = 0.6;
+constexpr double kDomesticFraction = 0.65;
+constexpr double kReturnRouteFraction = 0.9;
+
+const char kCodeAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+// Alphanumeric code for a sequence number, or "" once the code space is used up
+std::string make_code(size_t n, int length) {
+    size_t space = 1;
+    for (int i = 0; i < length; ++i) space *= 36;
+    if (n >= space) return "";
+    std::string code(length, 'A');
+    for (int i = length - 1; i >= 0; --i) {
+        code[i] = kCodeAlphabet[n % 36];
+        n /= 36;
+    }
+    return code;
+}
+
+struct Generated {
+    std::vector<Airport> airports;
+    std::vector<double> airport_weight;
+    std::vector<Airline> airlines;
+    std::vector<double> airline_weight;
+    std::vector<Route> routes;
+};
+
+double distance_km(const Airport& a, const Airport& b) {
+    constexpr double kRad = M_PI / 180.0;
+    double dlat = (b.latitude - a.latitude) * kRad;
+    double dlon = (b.longitude - a.longitude) * kRad;
+    double h = std::sin(dlat / 2) * std::sin(dlat / 2) +
+               std::cos(a.latitude * kRad) * std::cos(b.latitude * kRad) *
+               std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 6371.0 * 2 * std::atan2(std::sqrt(h), std::sqrt(1 - h));
+}
+
+std::string equipment_for(double km, std::mt19937& rng) {
+    static const std::vector<std::string> regional = {"CR2", "DH4", "AT7", "E90", "CRJ"};
+    static const std::vector<std::string> narrow = {"320", "738", "319", "321", "73H", "32N"};
+    static const std::vector<std::string> wide = {"77W", "388", "789", "333", "359", "744"};
+    const auto& pool = km < 600 ? regional : km < 4000 ? narrow : wide;
+    std::uniform_int_distribution<size_t> pick(0, pool.size() - 1);
+    std::string equipment = pool[pick(rng)];
+    if (rng() % 3 == 0) equipment += " " + pool[pick(rng)];
+    return equipment;
+}
+
+void generate_airports(const std::vector<Airport>& seeds, const Config& config,
+                       std::mt19937& rng, Generated& out) {
+    size_t count = static_cast<size_t>(seeds.size() * config.scale);
+    std::uniform_int_distribution<size_t> pick_seed(0, seeds.size() - 1);
+    std::normal_distribution<double> jitter(0.0, 1.5);
+    // Pareto(alpha = 1.2) popularity: a few airports attract most routes
+    std::uniform_real_distribution<double> unit(1e-9, 1.0);
+
+    out.airports.reserve(count);
+    out.airport_weight.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Airport& seed = seeds[pick_seed(rng)];
+        Airport airport = seed;
+        airport.id = static_cast<int>(i + 1);
+        airport.name = seed.city + " Synthetic " + std::to_string(i + 1);
+        airport.iata = make_code(i, 3);
+        airport.icao = make_code(i, 4);
+        airport.latitude = std::clamp(seed.latitude + jitter(rng), -89.9, 89.9);
+        airport.longitude = std::remainder(seed.longitude + jitter(rng), 360.0);
+        airport.source = "Synthetic";
+        out.airports.push_back(airport);
+        out.airport_weight.push_back(std::pow(unit(rng), -1.0 / 1.2));
+    }
+}
+
+void generate_airlines(const std::vector<Airline>& seeds, std::mt19937& rng, Generated& out) {
+    size_t count = static_cast<size_t>(out.airports.size() * kAirlinesPerAirport);
+    std::uniform_int_distribution<size_t> pick_seed(0, seeds.size() - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    out.airlines.reserve(count);
+    out.airline_weight.reserve(count);
+    size_t active_rank = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const Airline& seed = seeds[pick_seed(rng)];
+        Airline airline = seed;
+        airline.id = static_cast<int>(i + 1);
+        airline.name = "Synthetic Air " + std::to_string(i + 1);
+        airline.alias = "\\N";
+        airline.iata = make_code(i, 2);
+        airline.icao = make_code(i, 3);
+        airline.callsign = "SYN" + std::to_string(i + 1);
+        bool active = unit(rng) < kActiveAirlineFraction && !airline.iata.empty();
+        airline.active = active ? "Y" : "N";
+        out.airlines.push_back(airline);
+        // Zipf-like network sizes among active carriers; inactive ones fly nothing
+        out.airline_weight.push_back(active ? std::pow(1.0 + active_rank++, -0.8) : 0.0);
+    }
+}
+
+void generate_routes(std::mt19937& rng, Generated& out) {
+    const auto& airports = out.airports;
+    size_t target = static_cast<size_t>(airports.size() * kRoutesPerAirport);
+
+    // Per-country airport pools for domestic/regional routes
+    std::unordered_map<std::string, std::vector<size_t>> by_country;
+    for (size_t i = 0; i < airports.size(); ++i) {
+        by_country[airports[i].country].push_back(i);
+    }
+    std::unordered_map<std::string, std::discrete_distribution<size_t>> country_dist;
+    for (const auto& [country, members] : by_country) {
+        std::vector<double> weights;
+        for (size_t idx : members) weights.push_back(out.airport_weight[idx]);
+        country_dist.emplace(country, std::discrete_distribution<size_t>(weights.begin(), weights.end()));
+    }
+
+    std::discrete_distribution<size_t> global_airport(out.airport_weight.begin(), out.airport_weight.end());
+    std::discrete_distribution<size_t> pick_airline(out.airline_weight.begin(), out.airline_weight.end());
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    auto pick_in_country = [&](const std::string& country) {
+        auto& members = by_country[country];
+        return members[country_dist.at(country)(rng)];
+    };
+
+    // Each airline gets 1-3 hubs in its home country (or anywhere if none match)
+    std::unordered_map<int, std::vector<size_t>> hubs;
+    auto hubs_for = [&](const Airline& airline) -> const std::vector<size_t>& {
+        auto it = hubs.find(airline.id);
+        if (it != hubs.end()) return it->second;
+        std::vector<size_t> chosen;
+        int count = 1 + static_cast<int>(rng() % 3);
+        for (int i = 0; i < count; ++i) {
+            chosen.push_back(by_country.count(airline.country) ? pick_in_country(airline.country)
+                                                              : global_airport(rng));
+        }
+        return hubs.emplace(airline.id, std::move(chosen)).first->second;
+    };
+
+    std::unordered_set<std::string> keys;
+    auto add_route = [&](const Airline& airline, size_t source, size_t dest) {
+        if (source == dest) return false;
+        const Airport& a = airports[source];
+        const Airport& b = airports[dest];
+        Route route;
+        route.airline_iata = airline.iata;
+        route.airline_id = airline.id;
+        route.source_airport_iata = a.iata.empty() ? "\\N" : a.iata;
+        route.source_airport_id = a.id;
+        route.dest_airport_iata = b.iata.empty() ? "\\N" : b.iata;
+        route.dest_airport_id = b.id;
+        route.codeshare = unit(rng) < 0.2 ? "Y" : "";
+        route.stops = unit(rng) < 0.005 ? 1 : 0;
+        route.equipment = equipment_for(distance_km(a, b), rng);
+        if (!keys.insert(route.get_key()).second) return false;
+        out.routes.push_back(std::move(route));
+        return true;
+    };
+
+    out.routes.reserve(target);
+    size_t attempts = 0;
+    while (out.routes.size() < target && attempts++ < target * 10) {
+        const Airline& airline = out.airlines[pick_airline(rng)];
+        const auto& airline_hubs = hubs_for(airline);
+
+        size_t source = unit(rng) < kHubRouteFraction
+                            ? airline_hubs[rng() % airline_hubs.size()]
+                            : global_airport(rng);
+        const std::string& country = airports[source].country;
+        size_t dest = unit(rng) < kDomesticFraction ? pick_in_country(country) : global_airport(rng);
+
+        if (add_route(airline, source, dest) && unit(rng) < kReturnRouteFraction) {
+            add_route(airline, dest, source);
+        }
+    }
+}
+
+bool write_csv(const std::string& path, const std::vector<std::string>& lines) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write " << path << std::endl;
+        return false;
+    }
+    for (const auto& line : lines) file << line << '\n';
+    return true;
+}
+
+void print_degree_summary(const Generated& out) {
+    std::unordered_map<int, size_t> degree;
+    for (const auto& route : out.routes) {
+        degree[route.source_airport_id]++;
+        degree[route.dest_airport_id]++;
+    }
+    std::vector<size_t> degrees;
+    for (const auto& [id, d] : degree) degrees.push_back(d);
+    std::sort(degrees.rbegin(), degrees.rend());
+    if (degrees.empty()) return;
+
+    size_t top_one_percent = 0;
+    for (size_t i = 0; i < std::max<size_t>(degrees.size() / 100, 1); ++i) top_one_percent += degrees[i];
+    std::cerr << "Degree distribution: " << degrees.size() << " connected airports, max "
+              << degrees.front() << ", median " << degrees[degrees.size() / 2]
+              << ", top 1% carry " << std::fixed << std::setprecision(1)
+              << 100.0 * top_one_percent / (2.0 * out.routes.size()) << "% of route endpoints"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed-dir" && i + 1 < argc) {
+            config.seed_dir = argv[++i];
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            config.out_dir = argv[++i];
+        } else if (arg == "--scale" && i + 1 < argc) {
+            config.scale = std::stod(argv[++i]);
+        } else if (arg == "--random-seed" && i + 1 < argc) {
+            config.random_seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Usage: " << argv[0] << " [options]\n"
+                      << "Options:\n"
+                      << "  --seed-dir <path>    Real OpenFlights data to take the shape from (default: data)\n"
+                      << "  --out-dir <path>     Existing directory for the generated CSVs (default: .)\n"
+                      << "  --scale <factor>     Size relative to the seed data (default: 10)\n"
+                      << "  --random-seed <n>    Seed for reproducible output (default: 42)\n"
+                      << "  --help, -h           Show this help message\n";
+            return 0;
+        }
+    }
+
+    if (config.scale <= 0) {
+        std::cerr << "--scale must be positive" << std::endl;
+        return 1;
+    }
+
+    auto seed_airports = CSVParser::parse_airports(config.seed_dir + "/airports.csv");
+    auto seed_airlines = CSVParser::parse_airlines(config.seed_dir + "/airlines.csv");
+    if (seed_airports.empty() || seed_airlines.empty()) {
+        std::cerr << "Failed to load seed data from " << config.seed_dir << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(config.random_seed);
+    Generated out;
+    generate_airports(seed_airports, config, rng, out);
+    generate_airlines(seed_airlines, rng, out);
+    generate_routes(rng, out);
+
+    std::vector<std::string> lines;
+    lines.reserve(out.routes.size());
+    for (const auto& airport : out.airports) lines.push_back(airport.to_csv());
+    if (!write_csv(config.out_dir + "/airports.csv", lines)) return 1;
+
+    lines.clear();
+    for (const auto& airline : out.airlines) lines.push_back(airline.to_csv());
+    if (!write_csv(config.out_dir + "/airlines.csv", lines)) return 1;
+
+    lines.clear();
+    for (const auto& route : out.routes) lines.push_back(route.to_csv());
+    if (!write_csv(config.out_dir + "/routes.csv", lines)) return 1;
+
+    std::cerr << "Generated " << out.airports.size() << " airports, " << out.airlines.size()
+              << " airlines, " << out.routes.size() << " routes in " << config.out_dir << std::endl;
+    print_degree_summary(out);
+    return 0;
+}